@@ -0,0 +1,411 @@
+// Matching benchmark on synthetic fleets, without a simulation.
+//
+// Vehicles are placed uniformly on a square sized for the requested density
+// and move in straight lines between rounds, wrapping around the edges. In
+// every round a fraction of the vehicles has a ready task and the matcher
+// assigns them; the latency of each round is measured around Matcher::run().
+//
+// With --check N it instead solves N small random problems with the one task
+// per fog node engines and compares their objectives to an exhaustive search,
+// then runs warm started rounds on several thread counts and compares those.
+
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "matching/Matcher.h"
+
+namespace {
+
+struct Options {
+    std::vector<int> vehicles{10, 100, 1000, 10000, 100000};
+    std::vector<std::string> engines{"auction"};
+    double density = 100; // vehicles per km^2
+    std::string speedDistribution = "uniform"; // "uniform", "normal" or "constant"
+    double speedMean = 14; // m/s
+    double speedSpread = 6; // m/s, half width for uniform, standard deviation for normal
+    double fogFraction = 0.4;
+    double readyFraction = 0.3;
+    double roundInterval = 1; // s of movement between rounds
+    double rangeRadius = 400; // m
+    int rounds = 20;
+    int warmupRounds = 2;
+    int threads = 1;
+    bool warmStart = true;
+    unsigned seed = 1;
+    double maxP99 = 0; // ms, 0 for no limit
+    int checks = 0; // small problems compared to exhaustive search, 0 to benchmark
+};
+
+void usage(const char *program) {
+    std::printf("usage: %s [options]\n"
+                "  --vehicles LIST         fleet sizes, comma separated (10,100,1000,10000,100000)\n"
+                "  --engines LIST          matchers, comma separated (auction)\n"
+                "  --density D             vehicles per km^2 (100)\n"
+                "  --speed-dist NAME       uniform, normal or constant (uniform)\n"
+                "  --speed-mean V          mean speed in m/s (14)\n"
+                "  --speed-spread V        half width (uniform) or standard deviation (normal) in m/s (6)\n"
+                "  --fog-fraction F        share of vehicles with a contract (0.4)\n"
+                "  --ready-fraction F      share of the other vehicles with a task per round (0.3)\n"
+                "  --round-interval T      seconds of movement between rounds (1)\n"
+                "  --range R               range radius in m (400)\n"
+                "  --rounds N              measured rounds per fleet (20)\n"
+                "  --warmup N              unmeasured rounds before them (2)\n"
+                "  --threads N             matching threads, 0 for one per core (1)\n"
+                "  --cold                  disable warm starts\n"
+                "  --seed S                random seed (1)\n"
+                "  --max-p99 MS            exit with status 1 if any p99 latency exceeds MS\n"
+                "  --check N               compare auction and flow to exhaustive search on N small problems\n"
+                "                          and across thread counts instead of benchmarking, exit with\n"
+                "                          status 1 on a mismatch\n",
+                program);
+}
+
+template <typename T>
+std::vector<T> parseList(const char *text) {
+    std::vector<T> values;
+    std::stringstream stream(text);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        std::stringstream itemStream(item);
+        T value;
+        itemStream >> value;
+        values.push_back(value);
+    }
+    return values;
+}
+
+bool parseOptions(int argc, char **argv, Options &options) {
+    for (int a = 1; a < argc; a++) {
+        std::string name = argv[a];
+        if (name == "--cold") {
+            options.warmStart = false;
+            continue;
+        }
+        if (name == "--help" || a + 1 >= argc) {
+            return false;
+        }
+        const char *value = argv[++a];
+        if (name == "--vehicles") {
+            options.vehicles = parseList<int>(value);
+        } else if (name == "--engines") {
+            options.engines = parseList<std::string>(value);
+        } else if (name == "--density") {
+            options.density = std::atof(value);
+        } else if (name == "--speed-dist") {
+            options.speedDistribution = value;
+        } else if (name == "--speed-mean") {
+            options.speedMean = std::atof(value);
+        } else if (name == "--speed-spread") {
+            options.speedSpread = std::atof(value);
+        } else if (name == "--fog-fraction") {
+            options.fogFraction = std::atof(value);
+        } else if (name == "--ready-fraction") {
+            options.readyFraction = std::atof(value);
+        } else if (name == "--round-interval") {
+            options.roundInterval = std::atof(value);
+        } else if (name == "--range") {
+            options.rangeRadius = std::atof(value);
+        } else if (name == "--rounds") {
+            options.rounds = std::atoi(value);
+        } else if (name == "--warmup") {
+            options.warmupRounds = std::atoi(value);
+        } else if (name == "--threads") {
+            options.threads = std::atoi(value);
+        } else if (name == "--seed") {
+            options.seed = static_cast<unsigned>(std::atol(value));
+        } else if (name == "--max-p99") {
+            options.maxP99 = std::atof(value);
+        } else if (name == "--check") {
+            options.checks = std::atoi(value);
+        } else {
+            return false;
+        }
+    }
+    return options.rounds > 0 && (options.speedDistribution == "uniform" || options.speedDistribution == "normal" ||
+                                  options.speedDistribution == "constant");
+}
+
+class Fleet {
+private:
+    const Options &options;
+    std::mt19937 random;
+    double side; // m
+
+    double speed() {
+        if (options.speedDistribution == "normal") {
+            return std::max(0.0, std::normal_distribution<double>(options.speedMean, options.speedSpread)(random));
+        } else if (options.speedDistribution == "uniform") {
+            return std::uniform_real_distribution<double>(std::max(0.0, options.speedMean - options.speedSpread),
+                                                          options.speedMean + options.speedSpread)(random);
+        }
+        return options.speedMean;
+    }
+
+public:
+    MatchingProblem problem;
+
+    Fleet(const Options &options, int size)
+        : options(options)
+        , random(options.seed)
+        , side(std::sqrt(size / options.density) * 1000) {
+        std::uniform_real_distribution<double> unit(0, 1);
+        problem.rangeRadius = options.rangeRadius;
+        problem.vehicles.resize(size);
+        for (MatchingVehicle &v : problem.vehicles) {
+            v.x = unit(random) * side;
+            v.y = unit(random) * side;
+            double heading = unit(random) * 2 * M_PI;
+            double s = speed();
+            v.speedX = s * std::cos(heading);
+            v.speedY = s * std::sin(heading);
+            if (unit(random) < options.fogFraction) {
+                v.sharedResource = 2 + 13 * unit(random);
+            }
+        }
+    }
+
+    // Moves every vehicle by one round and draws the tasks of the round
+    void advance() {
+        std::uniform_real_distribution<double> unit(0, 1);
+        for (MatchingVehicle &v : problem.vehicles) {
+            v.x = std::fmod(v.x + v.speedX * options.roundInterval + side, side);
+            v.y = std::fmod(v.y + v.speedY * options.roundInterval + side, side);
+            v.isTaskReady = v.sharedResource == 0 && unit(random) < options.readyFraction;
+            if (v.isTaskReady) {
+                v.taskResource = 5 + 10 * unit(random);
+                v.taskDataSize = 1000 + 2000 * unit(random);
+                v.delayConstraint = 0.5 + unit(random);
+            }
+            v.capacity = v.sharedResource;
+        }
+    }
+};
+
+double percentile(std::vector<double> values, double p) {
+    std::sort(values.begin(), values.end());
+    size_t index = static_cast<size_t>(std::ceil(p * values.size()));
+    return values[std::min(values.size() - 1, index == 0 ? 0 : index - 1)];
+}
+
+// Best objective over all ways to give each requester row from `row` on a
+// distinct feasible fog node or the RSU
+double exhaustiveObjective(const FeasibilityMatrix &feasibility, int row, std::vector<bool> &taken) {
+    if (row == feasibility.rows()) {
+        return 0;
+    }
+    double best = exhaustiveObjective(feasibility, row + 1, taken);
+    for (size_t k = feasibility.rowBegin(row); k < feasibility.rowEnd(row); k++) {
+        int node = feasibility.node(k);
+        if (!taken[node]) {
+            taken[node] = true;
+            best = std::max(best, 1 / feasibility.totalTime(k) + exhaustiveObjective(feasibility, row + 1, taken));
+            taken[node] = false;
+        }
+    }
+    return best;
+}
+
+// Up to 12 vehicles on a 20 m square; the transmission rate of the cost model
+// falls off quickly with distance, so farther pairs are rarely feasible
+MatchingProblem smallProblem(std::mt19937 &random, double rangeRadius) {
+    std::uniform_real_distribution<double> unit(0, 1);
+    MatchingProblem problem;
+    problem.rangeRadius = rangeRadius;
+    problem.vehicles.resize(2 + random() % 11);
+    for (MatchingVehicle &v : problem.vehicles) {
+        v.x = unit(random) * 20;
+        v.y = unit(random) * 20;
+        v.speedX = 30 * unit(random) - 15;
+        v.speedY = 30 * unit(random) - 15;
+        if (unit(random) < 0.5) {
+            v.sharedResource = 2 + 13 * unit(random);
+            v.capacity = v.sharedResource;
+        } else {
+            v.isTaskReady = true;
+            v.taskResource = 5 + 10 * unit(random);
+            v.taskDataSize = 1000 + 2000 * unit(random);
+            v.delayConstraint = 0.5 + unit(random);
+        }
+    }
+    return problem;
+}
+
+// Returns the number of problems on which an engine misses the optimum. The
+// auction may stay below it by its final epsilon per requester.
+int checkOptimality(const Options &options) {
+    std::mt19937 random(options.seed);
+    const char *engines[] = {"auction", "flow"};
+    int mismatches = 0;
+    for (int check = 0; check < options.checks; check++) {
+        MatchingProblem problem = smallProblem(random, options.rangeRadius);
+        FeasibilityMatrix feasibility;
+        feasibility.build(problem);
+        std::vector<bool> taken(problem.size(), false);
+        double optimum = exhaustiveObjective(feasibility, 0, taken);
+        double maxValue = 0;
+        for (size_t k = 0; k < feasibility.entries(); k++) {
+            maxValue = std::max(maxValue, 1 / feasibility.totalTime(k));
+        }
+
+        for (const char *engine : engines) {
+            std::unique_ptr<Matcher> matcher(createMatcher(engine));
+            MatchingProblem copy = problem;
+            MatchResult result = matcher->run(copy);
+            double rounding = 1e-9 * (1 + optimum);
+            double epsilon = engine == std::string("auction") ? 1e-6 * maxValue * feasibility.rows() : 0;
+            if (!result.success || result.objective > optimum + rounding ||
+                result.objective < optimum - rounding - epsilon) {
+                std::printf("problem %d (%d vehicles): %s objective %.9f, exhaustive %.9f\n", check, problem.size(),
+                            engine, result.objective, optimum);
+                mismatches++;
+            }
+        }
+    }
+    std::printf("%d problems, %d mismatches against exhaustive search\n", options.checks, mismatches);
+    return mismatches;
+}
+
+// Returns the number of rounds in which an engine's result depends on the
+// thread count. Any count other than 1 must give the same assignments; one
+// thread solves in one piece and must reach the same objective up to the
+// auction's final epsilon per requester.
+int checkThreadCounts(const Options &options) {
+    const char *engines[] = {"auction", "flow"};
+    const int threadCounts[] = {1, 2, 4, 0};
+    const int size = 2000;
+    const int rounds = 5;
+    int mismatches = 0;
+    for (const char *engine : engines) {
+        std::vector<std::unique_ptr<Fleet>> fleets;
+        std::vector<std::unique_ptr<Matcher>> matchers;
+        for (int threads : threadCounts) {
+            fleets.emplace_back(new Fleet(options, size));
+            matchers.emplace_back(createMatcher(engine));
+            matchers.back()->setThreads(threads);
+        }
+        for (int round = 0; round < rounds; round++) {
+            std::vector<MatchResult> results;
+            for (size_t t = 0; t < fleets.size(); t++) {
+                fleets[t]->advance();
+                results.push_back(matchers[t]->run(fleets[t]->problem));
+            }
+            FeasibilityMatrix feasibility;
+            feasibility.build(fleets[0]->problem);
+            double maxValue = 0;
+            for (size_t k = 0; k < feasibility.entries(); k++) {
+                maxValue = std::max(maxValue, 1 / feasibility.totalTime(k));
+            }
+            double epsilon = engine == std::string("auction") ? 1e-6 * maxValue * feasibility.rows() : 0;
+            double rounding = 1e-9 * (1 + results[0].objective);
+
+            for (size_t t = 1; t < results.size(); t++) {
+                bool same = results[t].success == results[0].success &&
+                            std::abs(results[t].objective - results[0].objective) <= rounding + epsilon;
+                if (t > 1) {
+                    same = same && results[t].assignment == results[1].assignment;
+                }
+                if (!same) {
+                    std::printf("%s round %d: %d threads objective %.9f, 1 thread %.9f%s\n", engine, round,
+                                threadCounts[t], results[t].objective, results[0].objective,
+                                t > 1 ? ", or assignments differ from 2 threads" : "");
+                    mismatches++;
+                }
+            }
+        }
+    }
+    std::printf("%d vehicles over %d rounds, %d mismatches across thread counts\n", size, rounds, mismatches);
+    return mismatches;
+}
+
+long peakMemoryKiB() {
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+}
+
+// Benchmarks one engine on one fleet size and prints its row. Returns 1 if
+// its p99 latency exceeds maxP99, otherwise 0.
+int benchmark(const Options &options, const std::string &engine, int size) {
+    std::unique_ptr<Matcher> matcher(createMatcher(engine));
+    matcher->setWarmStart(options.warmStart);
+    matcher->setThreads(options.threads);
+
+    Fleet fleet(options, size);
+    std::vector<double> latencies;
+    double iterations = 0;
+    double objective = 0;
+    for (int round = 0; round < options.warmupRounds + options.rounds; round++) {
+        fleet.advance();
+        MatchResult result = matcher->run(fleet.problem);
+        if (!result.success) {
+            std::fprintf(stderr, "%s failed on %d vehicles in round %d\n", engine.c_str(), size, round);
+        }
+        if (round >= options.warmupRounds) {
+            latencies.push_back(result.wallTime * 1000);
+            iterations += result.iterations;
+            objective += result.objective;
+        }
+    }
+
+    double p99 = percentile(latencies, 0.99);
+    std::printf("%-9s %8d %9.3f %9.3f %9.3f %9.3f %11.1f %12.4f %10.1f\n", engine.c_str(), size,
+                percentile(latencies, 0.5), percentile(latencies, 0.9), p99,
+                *std::max_element(latencies.begin(), latencies.end()), iterations / options.rounds,
+                objective / options.rounds, peakMemoryKiB() / 1024.0);
+    std::fflush(stdout);
+    return options.maxP99 > 0 && p99 > options.maxP99 ? 1 : 0;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    Options options;
+    if (!parseOptions(argc, argv, options)) {
+        usage(argv[0]);
+        return 2;
+    }
+    if (options.checks > 0) {
+        int mismatches = checkOptimality(options);
+        mismatches += checkThreadCounts(options);
+        return mismatches > 0 ? 1 : 0;
+    }
+    for (const std::string &engine : options.engines) {
+        if (!std::unique_ptr<Matcher>(createMatcher(engine))) {
+            std::fprintf(stderr, "unknown engine \"%s\"\n", engine.c_str());
+            return 2;
+        }
+    }
+
+    // Every row runs in a process of its own, so its peak memory is not
+    // that of a larger fleet benchmarked before it
+    std::printf("%-9s %8s %9s %9s %9s %9s %11s %12s %10s\n", "engine", "vehicles", "p50 ms", "p90 ms", "p99 ms",
+                "max ms", "iterations", "objective", "peak MiB");
+    std::fflush(stdout);
+    bool regression = false;
+    for (const std::string &engine : options.engines) {
+        for (int size : options.vehicles) {
+            pid_t child = fork();
+            if (child == 0) {
+                std::exit(benchmark(options, engine, size));
+            }
+            int status;
+            if (child == -1 || waitpid(child, &status, 0) != child || !WIFEXITED(status)) {
+                std::fprintf(stderr, "benchmark of %s on %d vehicles did not finish\n", engine.c_str(), size);
+                return 2;
+            }
+            regression = regression || WEXITSTATUS(status) != 0;
+        }
+    }
+    return regression ? 1 : 0;
+}
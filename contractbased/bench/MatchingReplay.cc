@@ -0,0 +1,126 @@
+// Runs matchers on snapshots written by BaseStation (snapshotDir parameter).
+//
+// Every snapshot is solved by every engine from scratch, so results do not
+// depend on the order or the number of jobs; they are printed in input
+// order. The "proposal" engine draws from the shared rand(), so its results
+// are only reproducible with --jobs 1.
+
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "matching/Matcher.h"
+#include "matching/MatchingSnapshot.h"
+#include "matching/ThreadPool.h"
+
+namespace {
+
+struct Job {
+    size_t snapshot;
+    std::string engine;
+    bool loaded = false;
+    MatchResult result;
+    int requesters = 0;
+    int fogTasks = 0;
+};
+
+void usage(const char *program) {
+    std::printf("usage: %s [options] snapshot...\n"
+                "  --engines LIST   matchers, comma separated (auction)\n"
+                "  --jobs N         snapshots solved concurrently, 0 for one per core (0)\n"
+                "  --threads N      matching threads per solve (1)\n",
+                program);
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    std::vector<std::string> engines{"auction"};
+    std::vector<std::string> snapshots;
+    int jobs = 0;
+    int threads = 1;
+    for (int a = 1; a < argc; a++) {
+        std::string name = argv[a];
+        if (name.compare(0, 2, "--") != 0) {
+            snapshots.push_back(name);
+            continue;
+        }
+        if (name == "--help" || a + 1 >= argc) {
+            usage(argv[0]);
+            return 2;
+        }
+        const char *value = argv[++a];
+        if (name == "--engines") {
+            engines.clear();
+            std::stringstream stream(value);
+            std::string engine;
+            while (std::getline(stream, engine, ',')) {
+                engines.push_back(engine);
+            }
+        } else if (name == "--jobs") {
+            jobs = std::atoi(value);
+        } else if (name == "--threads") {
+            threads = std::atoi(value);
+        } else {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+    if (snapshots.empty()) {
+        usage(argv[0]);
+        return 2;
+    }
+    for (const std::string &engine : engines) {
+        if (!std::unique_ptr<Matcher>(createMatcher(engine))) {
+            std::fprintf(stderr, "unknown engine \"%s\"\n", engine.c_str());
+            return 2;
+        }
+    }
+
+    std::vector<Job> work;
+    for (size_t s = 0; s < snapshots.size(); s++) {
+        for (const std::string &engine : engines) {
+            work.push_back(Job());
+            work.back().snapshot = s;
+            work.back().engine = engine;
+        }
+    }
+
+    ThreadPool pool(jobs);
+    pool.parallelFor(static_cast<int>(work.size()), [&](int, int index) {
+        Job &job = work[index];
+        MatchingProblem problem;
+        if (!MatchingSnapshot::read(snapshots[job.snapshot], problem)) {
+            return;
+        }
+        job.loaded = true;
+        std::unique_ptr<Matcher> matcher(createMatcher(job.engine));
+        matcher->setThreads(threads);
+        job.result = matcher->run(problem);
+        for (int i = 0; i < problem.size(); i++) {
+            job.requesters += problem.vehicles[i].isTaskReady;
+            job.fogTasks += job.result.assignment[i] >= 0 && job.result.assignment[i] != i;
+        }
+    });
+
+    std::printf("%-40s %-9s %7s %10s %10s %9s %12s %10s\n", "snapshot", "engine", "success", "requesters", "fog tasks",
+                "iterations", "objective", "wall ms");
+    int failures = 0;
+    for (const Job &job : work) {
+        if (!job.loaded) {
+            if (job.engine == engines.front()) {
+                std::fprintf(stderr, "cannot read snapshot %s\n", snapshots[job.snapshot].c_str());
+            }
+            failures++;
+            continue;
+        }
+        failures += !job.result.success;
+        std::printf("%-40s %-9s %7s %10d %10d %9d %12.4f %10.3f\n", snapshots[job.snapshot].c_str(), job.engine.c_str(),
+                    job.result.success ? "yes" : "no", job.requesters, job.fogTasks, job.result.iterations,
+                    job.result.objective, job.result.wallTime * 1000);
+    }
+    return failures > 0 ? 1 : 0;
+}
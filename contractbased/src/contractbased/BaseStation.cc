@@ -1,11 +1,25 @@
 #include <omnetpp.h>
-#include <curl/curl.h>
-#include <nlohmann/json.hpp>
+#include <algorithm>
+#include <deque>
+#include <iomanip>
 #include <iostream>
+#include <limits>
+#include <sstream>
+#include <unordered_map>
+#include <unordered_set>
 
 #include "veins/base/modules/BaseApplLayer.h"
 #include "veins/base/modules/BaseMacLayer.h"
+#include "veins/modules/mobility/traci/TraCIScenarioManager.h"
 #include "message_m.h"
+#include "ContractSolver.h"
+#include "ContractMenuCache.h"
+#include "ComputeScheduler.h"
+#include "FleetRegistry.h"
+#include "Log.h"
+#include "matching/Matcher.h"
+#include "matching/MatchingSnapshot.h"
+#include "matching/SpatialGrid.h"
 
 using namespace std;
 using namespace omnetpp;
@@ -15,31 +29,22 @@ struct Vehicle {
     double taskResource;
     double taskDataSize;
     double delayConstraint;
-    double taskPrice;
-    double sharedResource;
+    double taskPrice = 0;
+    double sharedResource = 0;
     double price;
     bool isTaskReady = false;
     bool isTaskAssigned = false;
-    double *totalTime;
-    int taskAssignedFrom;
+    simtime_t taskReadyTime;
+    simtime_t taskAssignedTime;
 
     Coord position;
     Coord speed;
+    simtime_t positionTime;
+    double straightHorizon = -1;
 
     int address;
 };
 
-static size_t writeCallback(void *contents, size_t size, size_t nmemb, std::string *s) {
-    size_t newLength = size * nmemb;
-    try {
-        s->append((char *) contents, newLength);
-    } catch (std::bad_alloc &e) {
-        // handle memory problem
-        return 0;
-    }
-    return newLength;
-}
-
 class BaseStation : public BaseApplLayer {
 private:
     // Contrct
@@ -50,18 +55,96 @@ private:
     int totalVehicles;
     double deltaMin;
     double deltaMax;
+    ContractSolver *contractSolver = nullptr;
+    ContractMenuCache *contractCache = nullptr;
+    int contractCacheHits;
+    int contractCacheMisses;
 
     // Task Scheduler
     int taskAssignmentThreshold;
-    int numVehicles;
-    Vehicle *vehicles;
-
-    int lastVehicleId;
-    map<int, int> vehicleIdMap;
+    simtime_t maxBatchWait;
+    int readyCount;
+    cMessage *batchTimer = nullptr;
+    simsignal_t batchSizeSignal;
+    simsignal_t batchQueueingDelaySignal;
+    FleetRegistry fleet;
+    vector<Vehicle> vehicles; // by fleet slot
+    Matcher *matcher = nullptr;
+    MatchingProblem matchingProblem;
+    double rangeRadius;
+    double capacityWindow;
+    bool extrapolatePositions; // move the reported positions to the matching instant
+    ContactModel contactModel;
+    SpatialGrid fogNodeIndex;
+    simsignal_t matchingIterationsSignal;
+    simsignal_t matchingWallTimeSignal;
+    simsignal_t matchingObjectiveSignal;
+    simsignal_t matchingPriceSignal;
+    std::string snapshotDir;
+    int matchingRounds;
+    bool aggregateAssignments;
+    int assignmentsPerFrame;
+    // Payload of one assignment in either frame type: fog node, address and
+    // backup address as 32 bit fields, price and hedge delay as 64 bit ones.
+    // A batch entry also names its requester, which is the recipient of a
+    // unicast TaskAssignment and so already part of its header.
+    static constexpr int assignmentBits = 224;
+    static constexpr int assignmentEntryBits = assignmentBits + 32;
+
+    // Hedging
+    double hedgePercentile;
+    size_t hedgeWindow;
+    deque<double> completionDelays; // assignment to first completion, most recent last
 
     ContractList *contractList;
-
-    int baseStationTasks;
+    int macAddress = -1;
+    simtime_t beaconInterval;
+    cMessage *beaconTimer = nullptr;
+    unordered_set<int> handedOver; // addresses of vehicles that moved to another RSU, whose results are still relayed
+
+    // Computation
+    ComputeScheduler computeScheduler;
+    cMessage *computeTimer = nullptr;
+    unordered_map<long, Task *> runningTasks; // by message id
+    vector<ComputeScheduler::Completion> completedTasks;
+    simtime_t computeStart;
+    simsignal_t computeQueueingDelaySignal;
+    simsignal_t computeUtilisationSignal;
+
+    // Backhaul: a full mesh between the RSUs of the network, modelled as
+    // direct sends that take backhaulLatency plus the serialization time on
+    // a link of backhaulBandwidth, queued behind earlier messages on it
+    bool backhaulOffloading;
+    double backhaulThreshold;
+    simtime_t backhaulLatency;
+    double backhaulBandwidth;
+    simtime_t loadReportInterval;
+    cMessage *loadReportTimer = nullptr;
+    vector<cModule *> neighbours; // by RSU index, nullptr for this one
+    vector<simtime_t> linkFreeAt; // by RSU index
+    vector<double> neighbourBacklog; // by RSU index, as last reported plus the tasks forwarded since
+    vector<double> neighbourCapacity; // by RSU index, 0 until reported
+    struct ForwardedTask {
+        int requester; // address
+        int rsu; // index of the RSU computing it
+    };
+    unordered_map<long, ForwardedTask> forwardedTasks; // by id of the Task message
+    simsignal_t backhaulForwardedSignal;
+    int backhaulInGate;
+
+public:
+    ~BaseStation() override {
+        cancelAndDelete(batchTimer);
+        cancelAndDelete(beaconTimer);
+        cancelAndDelete(loadReportTimer);
+        cancelAndDelete(computeTimer);
+        for (auto &running : runningTasks) {
+            delete running.second;
+        }
+        delete contractSolver;
+        delete contractCache;
+        delete matcher;
+    }
 
 protected:
     virtual void initialize(int stage) override {
@@ -73,14 +156,11 @@ protected:
         totalVehicles = par("totalVehicles");
         deltaMin = par("deltaMin");
         deltaMax = par("deltaMax");
-        baseStationTasks = 0;
+        contractCacheHits = 0;
+        contractCacheMisses = 0;
 
         taskAssignmentThreshold = par("taskAssignmentThreshold");
-
-        numVehicles = totalVehicles;
-        vehicles = new Vehicle[numVehicles];
-
-        lastVehicleId = 0;
+        maxBatchWait = par("maxBatchWait");
 
         if (stage == 0) {
             cStringTokenizer tokenizer(par("typeProbability"), ",");
@@ -88,26 +168,168 @@ protected:
                 typeProbability.push_back(std::stod(tokenizer.nextToken()));
             }
 
-            cMessage *prepContractsMsg = new cMessage("prepareContracts");
+            contractSolver = createContractSolver(par("contractSolver").stdstringValue(),
+                                                  par("contractSolverUrl").stdstringValue());
+            if (!contractSolver) {
+                throw cRuntimeError("Unknown contract solver \"%s\"", par("contractSolver").stringValue());
+            }
+            matcher = createMatcher(par("matcher").stdstringValue());
+            if (!matcher) {
+                throw cRuntimeError("Unknown matcher \"%s\"", par("matcher").stringValue());
+            }
+            matcher->setWarmStart(par("warmStartMatching"));
+            matcher->setThreads(par("matchingThreads"));
+            matcher->setHedgeMargin(par("hedgeMargin"));
+            hedgePercentile = par("hedgePercentile");
+            hedgeWindow = par("hedgeWindow").intValue();
+            rangeRadius = par("rangeRadius");
+            string model = par("contactModel").stdstringValue();
+            if (model != "constant" && model != "extrapolated" && model != "route") {
+                throw cRuntimeError("Unknown contact model \"%s\"", model.c_str());
+            }
+            extrapolatePositions = model != "constant";
+            contactModel = model == "route" ? ContactModel::ROUTE : ContactModel::CONSTANT_VELOCITY;
+            capacityWindow = par("capacityWindow");
+            snapshotDir = par("snapshotDir").stdstringValue();
+            matchingRounds = 0;
+            aggregateAssignments = par("aggregateAssignments");
+            assignmentsPerFrame = (static_cast<int>(par("assignmentMtu")) * 8 - headerLength) / assignmentEntryBits;
+            if (aggregateAssignments && assignmentsPerFrame < 1) {
+                throw cRuntimeError("assignmentMtu leaves no room for an assignment");
+            }
+            fogNodeIndex.setCellSize(rangeRadius);
+            matchingIterationsSignal = registerSignal("matchingIterations");
+            matchingWallTimeSignal = registerSignal("matchingWallTime");
+            matchingObjectiveSignal = registerSignal("matchingObjective");
+            matchingPriceSignal = registerSignal("matchingPrice");
+            batchSizeSignal = registerSignal("batchSize");
+            batchQueueingDelaySignal = registerSignal("batchQueueingDelay");
+            readyCount = 0;
+            batchTimer = new cMessage("assignTasks", ASSIGN_TASKS);
+            beaconInterval = par("beaconInterval");
+            beaconTimer = new cMessage("contractBeacon", CONTRACT_BEACON);
+
+            ComputeScheduler::Policy policy;
+            if (!ComputeScheduler::parsePolicy(par("computePolicy").stdstringValue(), policy)) {
+                throw cRuntimeError("Unknown compute policy \"%s\"", par("computePolicy").stringValue());
+            }
+            computeScheduler = ComputeScheduler(policy, computationCapability);
+            computeTimer = new cMessage("computeTimer", COMPUTE_TIMER);
+            computeStart = simTime();
+            computeQueueingDelaySignal = registerSignal("computeQueueingDelay");
+            computeUtilisationSignal = registerSignal("computeUtilisation");
+            backhaulForwardedSignal = registerSignal("backhaulForwarded");
+            backhaulOffloading = par("backhaulOffloading");
+            backhaulThreshold = par("backhaulThreshold");
+            backhaulLatency = par("backhaulLatency");
+            backhaulBandwidth = par("backhaulBandwidth");
+            loadReportInterval = par("loadReportInterval");
+            loadReportTimer = new cMessage("loadReport", LOAD_REPORT_TIMER);
+            backhaulInGate = findGate("backhaulIn");
+
+            if (strlen(par("contractCacheDir").stringValue()) > 0) {
+                contractCache = new ContractMenuCache(par("contractCacheDir").stdstringValue());
+            }
+
+            // Free the slots of vehicles leaving the simulation
+            getSimulation()->getSystemModule()->subscribe(TraCIScenarioManager::traciModuleRemovedSignal, this);
+
+            cMessage *prepContractsMsg = new cMessage("prepareContracts", PREPARE_CONTRACTS);
             scheduleAt(4, prepContractsMsg);
+        } else if (stage == 1) {
+            // The other RSUs exist by now. Set up even without offloading, as
+            // neighbours that offload still send their load reports here.
+            cModule *rsu = getParentModule();
+            for (int i = 0; i < rsu->getVectorSize(); i++) {
+                cModule *other = rsu->getParentModule()->getSubmodule(rsu->getName(), i);
+                neighbours.push_back(i == rsu->getIndex() ? nullptr : other->getSubmodule("appl"));
+            }
+            linkFreeAt.assign(neighbours.size(), 0);
+            neighbourBacklog.assign(neighbours.size(), 0);
+            neighbourCapacity.assign(neighbours.size(), 0);
+            // Without offloading this RSU never reports, so it gets no forwarded tasks
+            if (backhaulOffloading) {
+                scheduleAt(simTime() + loadReportInterval, loadReportTimer);
+            }
+        }
+    }
+
+    virtual void finish() override {
+        BaseApplLayer::finish();
+        getSimulation()->getSystemModule()->unsubscribe(TraCIScenarioManager::traciModuleRemovedSignal, this);
+        // Count the busy time since the last event; tasks finishing now are not
+        // reported, as no frames can be sent any more
+        completedTasks.clear();
+        computeScheduler.advance(simTime().dbl(), completedTasks);
+        if (simTime() > computeStart) {
+            emit(computeUtilisationSignal, computeScheduler.getBusyTime() / (simTime() - computeStart).dbl());
         }
+        if (contractCache) {
+            recordScalar("contractCacheHits", contractCacheHits);
+            recordScalar("contractCacheMisses", contractCacheMisses);
+        }
+    }
+
+    using BaseApplLayer::receiveSignal;
+
+    virtual void receiveSignal(cComponent *source, simsignal_t signalID, cObject *obj, cObject *details) override {
+        if (signalID == TraCIScenarioManager::traciModuleRemovedSignal) {
+            removeVehicle(check_and_cast<cModule *>(obj));
+            return;
+        }
+        BaseApplLayer::receiveSignal(source, signalID, obj, details);
     }
 
     int getVehicleId(int addr) {
-        if (vehicleIdMap.find(addr) != vehicleIdMap.end()) {
-            return vehicleIdMap[addr];
-        } else {
-            cout << "Error in vehicle id map for addr " << addr << endl;
-            return -1;
+        int vehicleId = fleet.find(addr);
+        if (vehicleId == -1) {
+            LOG_INFO << "Error in vehicle id map for addr " << addr << endl;
         }
+        return vehicleId;
     }
 
-    int myAddress() {
-        auto *mac = static_cast<BaseMacLayer *>(getParentModule()->getSubmodule("nic")->getSubmodule("mac1609_4"));
+    int registerVehicle(int addr) {
+        int vehicleId = fleet.acquire(addr);
+        if (vehicleId >= static_cast<int>(vehicles.size())) {
+            vehicles.resize(fleet.capacity());
+        }
+        return vehicleId;
+    }
+
+    void removeVehicle(cModule *host) {
+        cModule *nic = host->getSubmodule("nic");
+        auto *mac = nic ? dynamic_cast<BaseMacLayer *>(nic->getSubmodule("mac1609_4")) : nullptr;
         if (!mac) {
-            throw cRuntimeError("MAC module not found");
+            return;
+        }
+        handedOver.erase(static_cast<int>(mac->myMacAddr));
+        releaseVehicle(static_cast<int>(mac->myMacAddr));
+    }
+
+    // Drops a vehicle that left the simulation or this RSU, with its pending task
+    void releaseVehicle(int addr) {
+        int vehicleId = fleet.release(addr);
+        if (vehicleId == -1) {
+            return;
         }
-        return static_cast<int>(mac->myMacAddr);
+        fogNodeIndex.remove(vehicleId);
+        if (vehicles[vehicleId].isTaskReady) {
+            readyCount--;
+        }
+        vehicles[vehicleId] = Vehicle();
+        LOG_DEBUG << "Vehicle: " << vehicleId << " left" << endl;
+    }
+
+    // Looked up once, the MAC address does not change
+    int myAddress() {
+        if (macAddress == -1) {
+            auto *mac = static_cast<BaseMacLayer *>(getParentModule()->getSubmodule("nic")->getSubmodule("mac1609_4"));
+            if (!mac) {
+                throw cRuntimeError("MAC module not found");
+            }
+            macAddress = static_cast<int>(mac->myMacAddr);
+        }
+        return macAddress;
     }
 
     cMessage *populate(cMessage *msg, int recipient) {
@@ -118,6 +340,7 @@ protected:
         baseMessage->setChannelNumber(178);
         baseMessage->setPsid(-1);
         baseMessage->setUserPriority(7);
+        baseMessage->setBitLength(headerLength);
         return baseMessage;
     }
 
@@ -127,30 +350,149 @@ protected:
     }
 
     virtual void handleSelfMsg(cMessage *msg) override {
-        // Check if this is the 'prepareContracts' self-message
-        if (msg->isName("prepareContracts")) {
-            prepareContracts(msg);
-        } else if (msg->isName("handleTask")) {
-            finishTask(msg);
+        switch (msg->getKind()) {
+            case ASSIGN_TASKS:
+                assignTasks();
+                return;
+            case PREPARE_CONTRACTS:
+                prepareContracts(msg);
+                break;
+            case COMPUTE_TIMER:
+                updateCompute();
+                scheduleComputeTimer();
+                return;
+            case CONTRACT_BEACON:
+                sendDown(contractList->dup());
+                scheduleAt(simTime() + beaconInterval, beaconTimer);
+                return;
+            case LOAD_REPORT_TIMER:
+                sendLoadReports();
+                scheduleAt(simTime() + loadReportInterval, loadReportTimer);
+                return;
+            default:
+                LOG_INFO << "BS received unknown self message" << endl;
+        }
+
+        delete msg;
+    }
+
+    virtual void handleMessage(cMessage *msg) override {
+        if (msg->getArrivalGateId() == backhaulInGate) {
+            handleBackhaulMsg(msg);
         } else {
-            cout << "BS received unknown self message" << endl;
+            BaseApplLayer::handleMessage(msg);
         }
+    }
 
+    void handleBackhaulMsg(cMessage *msg) {
+        switch (msg->getKind()) {
+            case LOAD_REPORT: {
+                LoadReport *report = check_and_cast<LoadReport *>(msg);
+                neighbourBacklog[report->getRsu()] = report->getBacklog();
+                neighbourCapacity[report->getRsu()] = report->getCapacity();
+                break;
+            }
+            case TASK:
+                handleTask(msg);
+                return; // kept until computed
+            case TASK_COMPLETION:
+                // The task this RSU forwarded; to the requester it ran here
+                forwardedTasks.erase(check_and_cast<TaskCompletion *>(msg)->getTaskId());
+                check_and_cast<TaskCompletion *>(msg)->setExecutor(myAddress());
+                handleTaskCompletion(msg);
+                return; // forwarded or deleted there
+            case TASK_CANCEL:
+                handleTaskCancel(msg);
+                break;
+        }
         delete msg;
     }
 
+    // Sends msg to the RSU with index rsu over the backhaul
+    void sendBackhaul(cMessage *msg, int rsu) {
+        simtime_t start = std::max(simTime(), linkFreeAt[rsu]);
+        cPacket *packet = dynamic_cast<cPacket *>(msg);
+        linkFreeAt[rsu] = start + (packet ? packet->getBitLength() / backhaulBandwidth : 0);
+        sendDirect(msg, linkFreeAt[rsu] - simTime() + backhaulLatency, 0, neighbours[rsu], "backhaulIn");
+    }
+
+    void sendLoadReports() {
+        updateCompute();
+        for (size_t i = 0; i < neighbours.size(); i++) {
+            if (!neighbours[i]) {
+                continue;
+            }
+            LoadReport *report = new LoadReport("loadReport", LOAD_REPORT);
+            report->setRsu(getParentModule()->getIndex());
+            report->setBacklog(computeScheduler.getBacklog());
+            report->setCapacity(computeScheduler.getCapacity());
+            sendBackhaul(report, i);
+        }
+    }
+
+    // While this RSU has more than backhaulThreshold of work queued, forwards
+    // the task to the other RSU that would start it soonest, if that is sooner
+    // than here. Returns whether the task was forwarded.
+    bool forwardTask(Task *task) {
+        if (!backhaulOffloading || task->getBackhaulOrigin() != -1 || computeScheduler.getCapacity() <= 0) {
+            return false;
+        }
+        double wait = computeScheduler.getBacklog() / computeScheduler.getCapacity();
+        if (wait <= backhaulThreshold) {
+            return false;
+        }
+        int target = -1;
+        double targetWait = wait;
+        for (size_t i = 0; i < neighbours.size(); i++) {
+            if (!neighbours[i] || neighbourCapacity[i] <= 0) {
+                continue;
+            }
+            double transfer = (std::max(simTime(), linkFreeAt[i]) - simTime() + backhaulLatency).dbl() +
+                              task->getBitLength() / backhaulBandwidth;
+            // The completion takes about as long to come back
+            double neighbourWait = neighbourBacklog[i] / neighbourCapacity[i] + 2 * transfer;
+            if (neighbourWait < targetWait) {
+                target = i;
+                targetWait = neighbourWait;
+            }
+        }
+        if (target == -1) {
+            return false;
+        }
+
+        LOG_DEBUG << "BaseStation forwards a task to rsu[" << target << "]" << endl;
+        emit(backhaulForwardedSignal, 1);
+        neighbourBacklog[target] += task->getTaskResource();
+        forwardedTasks[task->getId()] = ForwardedTask{task->getSender(), target};
+        delete task->removeControlInfo();
+        task->setBackhaulOrigin(getParentModule()->getIndex());
+        sendBackhaul(task, target);
+        return true;
+    }
+
     virtual void handleLowerMsg(cMessage *msg) override {
         if (isForMe(msg)) {
-            if (msg->isName("handleTaskMetadata")) {
-                handleTaskMetadata(msg);
-            } else if (msg->isName("chooseContract")) {
-                chooseContract(msg);
-            } else if (msg->isName("handleTask")) {
-                handleTask(msg);
-            } else if (msg->isName("handleTaskCompletion")) {
-                handleTaskCompletion(msg);
-            } else {
-                cout << "BS received unknown message" << endl;
+            switch (msg->getKind()) {
+                case TASK_METADATA:
+                    handleTaskMetadata(msg);
+                    break;
+                case CONTRACT_CHOICE:
+                    chooseContract(msg);
+                    break;
+                case TASK:
+                    handleTask(msg);
+                    return; // kept until computed
+                case TASK_COMPLETION:
+                    handleTaskCompletion(msg);
+                    return; // forwarded or deleted there
+                case TASK_CANCEL:
+                    handleTaskCancel(msg);
+                    break;
+                case DISASSOCIATE:
+                    handleDisassociate(msg);
+                    break;
+                default:
+                    LOG_INFO << "BS received unknown message" << endl;
             }
         }
 
@@ -158,87 +500,105 @@ protected:
     }
 
     void prepareContracts(cMessage *msg) {
-        CURL *curl;
-        CURLcode res;
-        std::string readBuffer;
-
-        struct curl_slist *headers = nullptr;
-        headers = curl_slist_append(headers, "Content-Type: application/json"); // Add Content-Type header
-        // Construct JSON payload
-        nlohmann::json data = {
-                {"unit_benefit",           unitBenefit},
-                {"computation_capability", computationCapability},
-                {"duration",               duration},
-                {"type_probability",       typeProbability},
-                {"total_vehicles",         totalVehicles},
-                {"delta_min",              deltaMin},
-                {"delta_max",              deltaMax}};
-        std::string jsonData = data.dump();
-
-        curl = curl_easy_init();
-        if (curl) {
-            curl_easy_setopt(curl, CURLOPT_URL, "http://localhost:9090");
-            curl_easy_setopt(curl, CURLOPT_POSTFIELDS, jsonData.c_str());
-            curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE, jsonData.size());
-            curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, writeCallback);
-            curl_easy_setopt(curl, CURLOPT_WRITEDATA, &readBuffer);
-            curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
-
-            res = curl_easy_perform(curl);
-
-            if (res == CURLE_OK) {
-                nlohmann::json responseJson = nlohmann::json::parse(readBuffer);
-                sendContractListToVehicles(responseJson);
-            } else {
-                EV << "curl_easy_perform() failed: " << curl_easy_strerror(res) << endl;
+        ContractParameters params;
+        params.unitBenefit = unitBenefit;
+        params.computationCapability = computationCapability;
+        params.duration = duration;
+        params.typeProbability = typeProbability;
+        params.totalVehicles = totalVehicles;
+        params.deltaMin = deltaMin;
+        params.deltaMax = deltaMax;
+
+        std::string cacheKey;
+        if (contractCache) {
+            ContractMenu menu;
+            cacheKey = ContractMenuCache::key(par("contractSolver").stdstringValue(),
+                                              par("contractSolverUrl").stdstringValue(), params);
+            if (contractCache->load(cacheKey, menu)) {
+                contractCacheHits++;
+                sendContractListToVehicles(menu);
+                return;
             }
+            contractCacheMisses++;
+        }
 
-            curl_easy_cleanup(curl);
+        ContractMenu menu;
+        try {
+            menu = contractSolver->solve(params);
+        } catch (const std::exception &e) {
+            EV << "Contract design failed: " << e.what() << endl;
+            return;
         }
-    }
 
-    void sendContractListToVehicles(const nlohmann::json &responseJson) {
-        auto deltas = responseJson["delta"];
-        auto pies = responseJson["pie"];
+        if (contractCache && !contractCache->store(cacheKey, menu)) {
+            EV << "Could not store contract menu in " << par("contractCacheDir").stringValue() << endl;
+        }
+        sendContractListToVehicles(menu);
+    }
 
+    void sendContractListToVehicles(const ContractMenu &menu) {
         // Create a new ContractList message
-        contractList = new ContractList("processContractList");
-        contractList->setContractsArraySize(deltas.size());
+        contractList = new ContractList("processContractList", CONTRACT_LIST);
+        contractList->setContractsArraySize(menu.deltas.size());
 
-        for (size_t i = 0; i < deltas.size(); ++i) {
+        for (size_t i = 0; i < menu.deltas.size(); ++i) {
             Contract contract;
-            contract.setResource(deltas[i]);
-            contract.setReward(pies[i]);
+            contract.setResource(menu.deltas[i]);
+            contract.setReward(menu.pies[i]);
             contractList->setContracts(i, contract);
         }
 
         populate(contractList, -1);
         sendDown(contractList->dup());
-        cout << "contracts are sent" << endl;
+        LOG_DEBUG << "contracts are sent" << endl;
+        if (beaconInterval > 0) {
+            scheduleAt(simTime() + beaconInterval, beaconTimer);
+        }
     }
 
     void chooseContract(cMessage *msg) {
         ContractChoice *choice = check_and_cast<ContractChoice *>(msg);
-        vehicleIdMap[choice->getSender()] = choice->getIndex();
-
         int type = choice->getType();
-        int vehicleId = getVehicleId(choice->getSender());
+        int vehicleId = registerVehicle(choice->getSender());
+        handedOver.erase(choice->getSender());
 
-        vehicles[vehicleId].position = choice->getPosition();
-        vehicles[vehicleId].speed = choice->getSpeed();
+        updateMobility(vehicleId, choice);
 
         vehicles[vehicleId].address = choice->getSender();
         if (type < 0) {
             vehicles[vehicleId].sharedResource = 0;
             vehicles[vehicleId].price = 0;
-            cout << "Vehicle: " << vehicleId << " has no contract" << endl;
-            return;
+            updateFogNodeIndex(vehicleId);
+            LOG_DEBUG << "Vehicle: " << vehicleId << " has no contract" << endl;
+        } else {
+            vehicles[vehicleId].sharedResource = contractList->getContracts(type).getResource();
+            vehicles[vehicleId].price = contractList->getContracts(type).getReward();
+            updateFogNodeIndex(vehicleId);
+
+            LOG_DEBUG << "Vehicle: " << vehicleId << " shared resource: " << vehicles[vehicleId].sharedResource << " price: "
+                      << vehicles[vehicleId].price << endl;
         }
-        vehicles[vehicleId].sharedResource = contractList->getContracts(type).getResource();
-        vehicles[vehicleId].price = contractList->getContracts(type).getReward();
 
-        cout << "Vehicle: " << vehicleId << " shared resource: " << vehicles[vehicleId].sharedResource << " price: "
-             << vehicles[vehicleId].price << endl;
+        if (choice->getHasTask()) {
+            LOG_DEBUG << "Received task metadata with the contract choice of vehicle: " << vehicleId << endl;
+            setTaskReady(vehicleId, choice->getTaskResource(), choice->getTaskDataSize(), choice->getDelayConstraint());
+        }
+    }
+
+    void updateMobility(int vehicleId, BaseMessageWithGeo *msg) {
+        vehicles[vehicleId].position = msg->getPosition();
+        vehicles[vehicleId].speed = msg->getSpeed();
+        vehicles[vehicleId].positionTime = msg->getPositionTime();
+        vehicles[vehicleId].straightHorizon = msg->getStraightHorizon();
+    }
+
+    void updateFogNodeIndex(int vehicleId) {
+        Vehicle &vehicle = vehicles[vehicleId];
+        if (vehicle.sharedResource > 0) {
+            fogNodeIndex.update(vehicleId, vehicle.position.getX(), vehicle.position.getY());
+        } else {
+            fogNodeIndex.remove(vehicleId);
+        }
     }
 
     void handleTaskMetadata(cMessage *msg) {
@@ -246,251 +606,321 @@ protected:
 
         int vehicleId = getVehicleId(taskMetadata->getSender());
         if (vehicleId == -1) {
-            cout << "Vehicle id not found" << endl;
+            LOG_INFO << "Vehicle id not found" << endl;
             return;
         }
 
-        cout << "Received task metadata from vehicle: " << vehicleId << endl;
-        vehicles[vehicleId].position = taskMetadata->getPosition();
-        vehicles[vehicleId].speed = taskMetadata->getSpeed();
-        vehicles[vehicleId].taskResource = taskMetadata->getTaskResource();
-        vehicles[vehicleId].taskDataSize = taskMetadata->getTaskDataSize();
-        vehicles[vehicleId].delayConstraint = taskMetadata->getDelayConstraint();
-        vehicles[vehicleId].isTaskReady = true;
-
-        int readyVehiclesCount = getReadyVehiclesCount();
-        cout << "Ready vehicles count: " << readyVehiclesCount << endl;
-        if (readyVehiclesCount >= taskAssignmentThreshold) {
-//            EV << "Vehicle vehicles[20] = {" << endl;
-//
-//            for (int i = 0; i < numVehicles; i++) {
-//                Vehicle vehicle = vehicles[i];
-//                EV << "    {"
-//                   << vehicle.taskResource << ", "
-//                   << vehicle.taskDataSize << ", "
-//                   << vehicle.delayConstraint << ", "
-//                   << vehicle.sharedResource << ", "
-//                   << vehicle.price << ", "
-//                   << (vehicle.isTaskReady ? "true" : "false");
-//                EV << "}" << endl;
-//            }
-//
-//            EV << "};" << endl;
+        LOG_DEBUG << "Received task metadata from vehicle: " << vehicleId << endl;
+        updateMobility(vehicleId, taskMetadata);
+        setTaskReady(vehicleId, taskMetadata->getTaskResource(), taskMetadata->getTaskDataSize(),
+                     taskMetadata->getDelayConstraint());
+    }
+
+    void setTaskReady(int vehicleId, double taskResource, double taskDataSize, double delayConstraint) {
+        vehicles[vehicleId].taskResource = taskResource;
+        vehicles[vehicleId].taskDataSize = taskDataSize;
+        vehicles[vehicleId].delayConstraint = delayConstraint;
+        if (!vehicles[vehicleId].isTaskReady) {
+            vehicles[vehicleId].isTaskReady = true;
+            vehicles[vehicleId].isTaskAssigned = false;
+            vehicles[vehicleId].taskReadyTime = simTime();
+            readyCount++;
+        }
+        updateFogNodeIndex(vehicleId);
+
+        LOG_DEBUG << "Ready vehicles count: " << readyCount << endl;
+        if (readyCount < taskAssignmentThreshold) {
+            // The first task of a batch starts the timer that bounds its wait
+            if (maxBatchWait >= 0 && !batchTimer->isScheduled()) {
+                scheduleAt(simTime() + maxBatchWait, batchTimer);
+            }
+        } else {
             assignTasks();
         }
     }
 
-    int getReadyVehiclesCount() {
-        int count = 0;
-        for (int i = 0; i < numVehicles; i++) {
-            if (vehicles[i].isTaskReady) {
-                count++;
+    // Refills the matching snapshot in place so its storage is reused across rounds
+    void updateMatchingProblem() {
+        MatchingProblem &problem = matchingProblem;
+        problem.rangeRadius = rangeRadius;
+        problem.rsuCapacity = computationCapability * capacityWindow;
+        problem.fogNodeIndex = &fogNodeIndex;
+        problem.contactModel = contactModel;
+        problem.vehicles.resize(vehicles.size());
+        for (size_t i = 0; i < vehicles.size(); i++) {
+            MatchingVehicle &v = problem.vehicles[i];
+            double age = extrapolatePositions ? (simTime() - vehicles[i].positionTime).dbl() : 0;
+            v.x = vehicles[i].position.getX() + vehicles[i].speed.getX() * age;
+            v.y = vehicles[i].position.getY() + vehicles[i].speed.getY() * age;
+            v.z = vehicles[i].position.getZ() + vehicles[i].speed.getZ() * age;
+            if (age > 0 && vehicles[i].sharedResource > 0) {
+                // The index must hold the positions matched on, not the reported ones
+                fogNodeIndex.update(i, v.x, v.y);
             }
+            v.speedX = vehicles[i].speed.getX();
+            v.speedY = vehicles[i].speed.getY();
+            v.speedZ = vehicles[i].speed.getZ();
+            v.taskResource = vehicles[i].taskResource;
+            v.taskDataSize = vehicles[i].taskDataSize;
+            v.delayConstraint = vehicles[i].delayConstraint;
+            v.sharedResource = vehicles[i].sharedResource;
+            v.taskPrice = vehicles[i].taskPrice;
+            v.capacity = vehicles[i].sharedResource * capacityWindow;
+            v.isTaskReady = vehicles[i].isTaskReady;
+            v.straightHorizon = vehicles[i].straightHorizon < 0 ? std::numeric_limits<double>::infinity()
+                                                                 : max(0.0, vehicles[i].straightHorizon - age);
         }
-        return count;
     }
 
+    // Dumps the matching input of this round for offline replay (bench/matching_replay)
+    void writeSnapshot() {
+        std::ostringstream path;
+        path << snapshotDir << "/" << getParentModule()->getFullName() << "-" << std::setw(6) << std::setfill('0')
+             << matchingRounds++ << ".snap";
+        if (!MatchingSnapshot::write(path.str(), matchingProblem)) {
+            EV << "Could not write matching snapshot " << path.str() << endl;
+        }
+    }
+
+    // Matches the tasks that arrived since the last batch
     void assignTasks() {
-        cout << "All vehicles are ready, assigning tasks..." << endl;
-        int proposals[numVehicles];
-
-        int remainingTasks = 0;
-        for (int i = 0; i < numVehicles; i++) {
-            proposals[i] = -1;
-            vehicles[i].totalTime = new double[numVehicles];
-            if (vehicles[i].isTaskReady) {
-                remainingTasks++;
-            }
+        cancelEvent(batchTimer);
+        if (readyCount == 0) {
+            return;
         }
+        LOG_DEBUG << "Assigning a batch of " << readyCount << " tasks..." << endl;
 
-        cout << "Remaining tasks: " << remainingTasks << endl;
-
-        int iterations = 0;
-
-        while (remainingTasks > 0) {
-            std::vector<int> assignedIds[numVehicles];
-            for (int i = 0; i < numVehicles; i++) {
-                if (proposals[i] != -1 || !vehicles[i].isTaskReady) {
-                    continue;
-                }
-                double maxPreference = 0;
-                int maxPreferenceId = i;
-                for (int j = 0; j < numVehicles; j++) {
-                    if (i == j || vehicles[j].sharedResource == 0) {
-                        continue;
-                    }
-                    vehicles[i].totalTime[j] = vehicles[i].taskResource / vehicles[j].sharedResource;
-                    double transmissionTime = getTransmissionTime(i, j);
-                    double transmissionConstraint = getTransmissionConstraint(i, j);
-                    if (transmissionConstraint > 0) {
-//                        cout << "transmission time from " << i << " to " << j << ": " << transmissionTime << endl;
-//                        cout << "transmission constraint from " << i << " to " << j << ": " << transmissionConstraint
-//                             << endl;
-                    }
-                    if (transmissionTime > transmissionConstraint) {
-                        continue;
-                    }
-                    vehicles[i].totalTime[j] += transmissionTime;
-//                    cout << "Total time: " << vehicles[i].totalTime[j] << endl;
-                    if (vehicles[i].totalTime[j] / 10 > vehicles[i].delayConstraint) {
-//                        cout << vehicles[i].totalTime[j] / 10 << " is greater than " << vehicles[i].delayConstraint << endl;
-                        continue;
-                    }
-                    double preference = 1 / vehicles[i].totalTime[j] - vehicles[j].taskPrice;
-                    if (preference > maxPreference || maxPreferenceId == i) {
-                        maxPreference = preference;
-                        maxPreferenceId = j;
-                    }
-                }
-                proposals[i] = maxPreferenceId;
-                assignedIds[maxPreferenceId].push_back(i);
-                remainingTasks--;
-            }
-            for (int i = 0; i < numVehicles; i++) {
-                if (assignedIds[i].size() > 1) {
-                    int skipIndex = -1;
-                    if (iterations >= 1000 && iterations % 1000 == 0) {
-                        skipIndex = rand() % assignedIds[i].size();
-                    }
-                    for (int j = 0; j < assignedIds[i].size(); j++) {
-                        if (j == skipIndex)
-                            continue;
-                        int id = assignedIds[i][j];
-                        proposals[id] = -1;
-                        remainingTasks++;
-                    }
-                    vehicles[i].taskPrice += getPriceIncrease(i);
-                }
-            }
-            if (iterations % 100 == 0) {
-                cout << "Iterations: " << iterations << " RemainingTasks: " << remainingTasks << endl;
+        updateMatchingProblem();
+        if (!snapshotDir.empty()) {
+            writeSnapshot();
+        }
+        MatchResult result = matcher->run(matchingProblem);
+
+        emit(matchingIterationsSignal, result.iterations);
+        emit(matchingWallTimeSignal, result.wallTime);
+        LOG_DEBUG << "Iterations: " << result.iterations << " wall time: " << result.wallTime << "s" << endl;
+        if (result.success) {
+            emit(matchingObjectiveSignal, result.objective);
+        }
+
+        double priceSum = 0;
+        int fogNodes = 0;
+        for (size_t i = 0; i < vehicles.size(); i++) {
+            vehicles[i].taskPrice = matchingProblem.vehicles[i].taskPrice;
+            if (vehicles[i].sharedResource > 0) {
+                priceSum += vehicles[i].taskPrice;
+                fogNodes++;
             }
-            if (iterations > 10000) {
-                cout << "Task assignment failed" << endl;
-                iterations = 0;
-                return;
+        }
+        if (fogNodes > 0) {
+            emit(matchingPriceSignal, priceSum / fogNodes);
+        }
+        if (!result.success) {
+            // Keep the tasks for the next batch
+            LOG_INFO << "Task assignment failed" << endl;
+            if (maxBatchWait >= 0) {
+                scheduleAt(simTime() + maxBatchWait, batchTimer);
             }
-            iterations++;
+            return;
         }
-        cout << "Task assignment is successful" << endl;
+        LOG_DEBUG << "Task assignment is successful" << endl;
+        emit(batchSizeSignal, readyCount);
 
-        for (int i = 0; i < numVehicles; i++) {
-            if (proposals[i] == -1) {
+        double hedgeDelay = estimateHedgeDelay();
+        vector<AssignmentEntry> entries;
+        for (int i = 0; i < static_cast<int>(vehicles.size()); i++) {
+            if (result.assignment[i] == -1) {
                 continue;
             }
-            int nodeId = proposals[i];
-
-            vehicles[nodeId].taskAssignedFrom = i;
+            int nodeId = result.assignment[i];
 
-            TaskAssignment *taskAssignment = new TaskAssignment("handleTaskAssignment");
+            vehicles[i].isTaskReady = false;
+            vehicles[i].isTaskAssigned = true;
+            vehicles[i].taskAssignedTime = simTime();
+            readyCount--;
+            emit(batchQueueingDelaySignal, simTime() - vehicles[i].taskReadyTime);
 
+            AssignmentEntry entry;
+            entry.requester = vehicles[i].address;
             if (nodeId == i) {
-                taskAssignment->setFogNodeId(-1);
-                taskAssignment->setPrice(0);
-                taskAssignment->setAddress(myAddress());
-
-                baseStationTasks++;
+                entry.fogNodeId = -1;
+                entry.price = 0;
+                entry.address = myAddress();
             } else {
-                taskAssignment->setFogNodeId(nodeId);
-                taskAssignment->setPrice(vehicles[nodeId].price);
-                taskAssignment->setAddress(vehicles[nodeId].address);
+                entry.fogNodeId = nodeId;
+                entry.price = vehicles[nodeId].price;
+                entry.address = vehicles[nodeId].address;
             }
+            int backup = result.backup[i];
+            entry.backupAddress = backup == -1 ? -1 : backup == i ? myAddress() : vehicles[backup].address;
+            entry.hedgeDelay = hedgeDelay >= 0 ? hedgeDelay : vehicles[i].delayConstraint;
 
-            populate(taskAssignment, vehicles[i].address);
+            if (aggregateAssignments) {
+                entries.push_back(entry);
+                continue;
+            }
+            TaskAssignment *taskAssignment = new TaskAssignment("handleTaskAssignment", TASK_ASSIGNMENT);
+            taskAssignment->setFogNodeId(entry.fogNodeId);
+            taskAssignment->setPrice(entry.price);
+            taskAssignment->setAddress(entry.address);
+            taskAssignment->setBackupAddress(entry.backupAddress);
+            taskAssignment->setHedgeDelay(entry.hedgeDelay);
+
+            populate(taskAssignment, entry.requester);
+            taskAssignment->addBitLength(assignmentBits);
             sendDown(taskAssignment);
         }
-    }
-
-    double getDistance(int sourceId, int destinationId) {
-        Coord sp = vehicles[sourceId].position;
-        Coord dp = vehicles[destinationId].position;
+        sendAssignmentBatches(entries);
 
-        double distanceX = dp.getX() - sp.getX();
-        double distanceY = dp.getY() - sp.getY();
-        double distanceZ = dp.getZ() - sp.getZ();
-        return sqrt(distanceX * distanceX + distanceY * distanceY + distanceZ * distanceZ);
+        // Tasks that found no capacity wait for the next batch
+        if (readyCount > 0 && maxBatchWait >= 0) {
+            scheduleAt(simTime() + maxBatchWait, batchTimer);
+        }
     }
 
-    double getTransmissionTime(int sourceId, int destinationId) {
-        return vehicles[sourceId].taskDataSize /
-               (3000000 * log(1 + pow(getDistance(sourceId, destinationId), -2) * 0.1));
+    // The hedgePercentile of the recent task delays, or -1 before any task completed
+    double estimateHedgeDelay() {
+        if (completionDelays.empty()) {
+            return -1;
+        }
+        vector<double> delays(completionDelays.begin(), completionDelays.end());
+        size_t rank = std::min(delays.size() - 1, static_cast<size_t>(hedgePercentile * delays.size()));
+        std::nth_element(delays.begin(), delays.begin() + rank, delays.end());
+        return delays[rank];
     }
 
-    double getTransmissionConstraint(int sourceId, int destinationId) {
-        Coord sp = vehicles[sourceId].position;
-        Coord dp = vehicles[destinationId].position;
-
-        Coord ss = vehicles[sourceId].speed;
-        Coord ds = vehicles[destinationId].speed;
-
-        double distanceX = dp.getX() - sp.getX();
-        double distanceY = dp.getY() - sp.getY();
-        double distanceZ = dp.getZ() - sp.getZ();
-//        double distanceZ = 0;
-        double distance = sqrt(distanceX * distanceX + distanceY * distanceY + distanceZ * distanceZ);
-
-        double relativeSpeedX = ds.getX() - ss.getX();
-        double relativeSpeedY = ds.getY() - ss.getY();
-        double relativeSpeedZ = ds.getZ() - ss.getZ();
-//        double relativeSpeedZ = 0;
-
-        double rangeRadius = 400;
-
-        if (rangeRadius - distance <= 0) {
-            return 0;
+    // Records the delay of the first completion of the task of vehicleId
+    void recordCompletion(int vehicleId) {
+        if (!vehicles[vehicleId].isTaskAssigned) {
+            return;
         }
-//        cout << "distance from " << sourceId << " to " << destinationId << " is " << distance << endl;
-
-
-        double a = relativeSpeedX * relativeSpeedX + relativeSpeedY * relativeSpeedY + relativeSpeedZ * relativeSpeedZ;
-        double b = 2 * (distanceX * relativeSpeedX + distanceY * relativeSpeedY + distanceZ * relativeSpeedZ);
-        double c = distanceX * distanceX + distanceY * distanceY + distanceZ * distanceZ - rangeRadius * rangeRadius;
-
-        double discriminant = b * b - 4 * a * c;
-        if (discriminant < 0) {
-            cout << "Discriminant is negative from " << sourceId << " to " << destinationId << endl;
-            return 1000000;
-        } else if (a == 0) {
-            return 1000000;
-        } else {
-            return (-b + sqrt(discriminant)) / (2 * a);
+        vehicles[vehicleId].isTaskAssigned = false;
+        completionDelays.push_back((simTime() - vehicles[vehicleId].taskAssignedTime).dbl());
+        if (completionDelays.size() > hedgeWindow) {
+            completionDelays.pop_front();
         }
     }
 
-    double getPriceIncrease(int id) {
-        return 0.001;
+    // Broadcasts the assignments in as few frames as assignmentMtu allows
+    void sendAssignmentBatches(const vector<AssignmentEntry> &entries) {
+        for (size_t first = 0; first < entries.size(); first += assignmentsPerFrame) {
+            size_t count = std::min(entries.size() - first, static_cast<size_t>(assignmentsPerFrame));
+            TaskAssignmentBatch *batch = new TaskAssignmentBatch("handleTaskAssignmentBatch", TASK_ASSIGNMENT_BATCH);
+            batch->setEntriesArraySize(count);
+            for (size_t e = 0; e < count; e++) {
+                batch->setEntries(e, entries[first + e]);
+            }
+
+            populate(batch, -1);
+            batch->addBitLength(assignmentEntryBits * count);
+            sendDown(batch);
+        }
     }
 
     void handleTaskCompletion(cMessage *msg) {
-        TaskCompletion *taskCompletion = (check_and_cast<TaskCompletion *>(msg))->dup();
-        int vehicleId = getVehicleId(taskCompletion->getSender());
-
-        int assignedFrom = vehicles[vehicleId].taskAssignedFrom;
+        TaskCompletion *taskCompletion = check_and_cast<TaskCompletion *>(msg);
+        int requester = taskCompletion->getRequester();
+        int requesterId = fleet.find(requester);
+        if (requesterId != -1) {
+            recordCompletion(requesterId);
+        } else if (!handedOver.count(requester)) {
+            LOG_INFO << "Vehicle: " << getVehicleId(taskCompletion->getSender()) << " completed a task of a vehicle that left"
+                     << endl;
+            delete taskCompletion;
+            return;
+        }
 
-        populate(taskCompletion, vehicles[assignedFrom].address);
+        // Forward the received frame itself, without the reception info of the MAC
+        delete taskCompletion->removeControlInfo();
+        populate(taskCompletion, requester);
         sendDown(taskCompletion);
     }
 
+    void handleDisassociate(cMessage *msg) {
+        int addr = check_and_cast<Disassociate *>(msg)->getSender();
+        releaseVehicle(addr);
+        handedOver.insert(addr);
+    }
+
+    void handleTaskCancel(cMessage *msg) {
+        int requester = check_and_cast<TaskCancel *>(msg)->getSender();
+        // The cancel names no task, so every copy of the requester's tasks
+        // here stops, including those forwarded over the backhaul
+        for (auto forwarded = forwardedTasks.begin(); forwarded != forwardedTasks.end();) {
+            if (forwarded->second.requester == requester) {
+                sendBackhaul(check_and_cast<TaskCancel *>(msg)->dup(), forwarded->second.rsu);
+                forwarded = forwardedTasks.erase(forwarded);
+            } else {
+                ++forwarded;
+            }
+        }
+        updateCompute();
+        for (auto running = runningTasks.begin(); running != runningTasks.end(); ++running) {
+            if (running->second->getSender() == requester) {
+                computeScheduler.remove(running->first);
+                delete running->second;
+                runningTasks.erase(running);
+                break;
+            }
+        }
+        scheduleComputeTimer();
+    }
+
+
     void handleTask(cMessage *msg) {
         Task *task = check_and_cast<Task *>(msg);
+        LOG_DEBUG << "BaseStation received task with resource " << task->getTaskResource() <<
+                  " at " << simTime() << endl;
 
-        // sleep for sharedResource / taskResource
-        simtime_t sleepTime = task->getTaskResource() / (computationCapability / baseStationTasks);
+        updateCompute();
+        if (forwardTask(task)) {
+            return;
+        }
+        computeScheduler.add(task->getId(), simTime().dbl(), task->getTaskResource(), task->getDeadline().dbl());
+        runningTasks[task->getId()] = task;
+        scheduleComputeTimer();
+    }
 
-        cout << "BaseStation received task with resource " << task->getTaskResource() <<
-             " at " << simTime() << " and sleeping for " << sleepTime << endl;
+    // Completes the tasks finished by now
+    void updateCompute() {
+        completedTasks.clear();
+        computeScheduler.advance(simTime().dbl(), completedTasks);
+        for (const ComputeScheduler::Completion &completion : completedTasks) {
+            Task *task = runningTasks[completion.id];
+            runningTasks.erase(completion.id);
+            emit(computeQueueingDelaySignal, completion.queueingDelay);
+            finishTask(task);
+            delete task;
+        }
+    }
 
-        scheduleAt(simTime() + sleepTime, task->dup());
+    void scheduleComputeTimer() {
+        cancelEvent(computeTimer);
+        double next = computeScheduler.nextCompletion();
+        if (next != std::numeric_limits<double>::infinity()) {
+            scheduleAt(std::max(simTime(), SimTime(next)), computeTimer);
+        }
     }
 
-    void finishTask(cMessage *msg) {
-        Task *task = check_and_cast<Task *>(msg);
-        cout << "BaseStation finished task with resource " << task->getTaskResource() <<
-             " at " << simTime() << endl;
+    void finishTask(Task *task) {
+        LOG_DEBUG << "BaseStation finished task with resource " << task->getTaskResource() <<
+                  " at " << simTime() << endl;
 
         // send task completion to base station
-        TaskCompletion *taskCompletion = new TaskCompletion("handleTaskCompletion");
+        TaskCompletion *taskCompletion = new TaskCompletion("handleTaskCompletion", TASK_COMPLETION);
         taskCompletion->setResult("Task completed");
+        taskCompletion->setRequester(task->getSender());
+        taskCompletion->setExecutor(myAddress());
+        if (task->getBackhaulOrigin() != -1) {
+            // The forwarding RSU relays it to the requester
+            taskCompletion->setTaskId(task->getId());
+            sendBackhaul(taskCompletion, task->getBackhaulOrigin());
+            return;
+        }
+        int requesterId = getVehicleId(task->getSender());
+        if (requesterId != -1) {
+            recordCompletion(requesterId);
+        }
 
         populate(taskCompletion, task->getSender());
         sendDown(taskCompletion);
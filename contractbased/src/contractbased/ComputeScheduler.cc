@@ -0,0 +1,139 @@
+#include "ComputeScheduler.h"
+
+#include <algorithm>
+#include <limits>
+
+ComputeScheduler::ComputeScheduler(Policy policy, double capacity)
+    : policy(policy)
+    , capacity(capacity) {
+}
+
+bool ComputeScheduler::parsePolicy(const std::string &name, Policy &policy) {
+    if (name == "fifo") {
+        policy = Policy::FIFO;
+    } else if (name == "ps") {
+        policy = Policy::PROCESSOR_SHARING;
+    } else if (name == "edf") {
+        policy = Policy::EDF;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+void ComputeScheduler::setCapacity(double value) {
+    capacity = value;
+}
+
+int ComputeScheduler::servedJob() const {
+    if (jobs.empty() || policy == Policy::PROCESSOR_SHARING) {
+        return -1;
+    }
+    if (policy == Policy::FIFO) {
+        return 0;
+    }
+    int served = 0;
+    for (int j = 1; j < size(); j++) {
+        if (jobs[j].deadline < jobs[served].deadline) {
+            served = j;
+        }
+    }
+    return served;
+}
+
+void ComputeScheduler::progress(double dt) {
+    if (jobs.empty() || dt <= 0) {
+        return;
+    }
+    busyTime += dt;
+    int served = servedJob();
+    if (served != -1) {
+        jobs[served].remaining -= capacity * dt;
+    } else {
+        double share = capacity / jobs.size() * dt;
+        for (Job &job : jobs) {
+            job.remaining -= share;
+        }
+    }
+}
+
+void ComputeScheduler::add(long id, double time, double work, double deadline) {
+    jobs.push_back(Job{id, time, deadline, work, work});
+}
+
+bool ComputeScheduler::remove(long id) {
+    auto job = std::find_if(jobs.begin(), jobs.end(), [id](const Job &job) {
+        return job.id == id;
+    });
+    if (job == jobs.end()) {
+        return false;
+    }
+    jobs.erase(job);
+    return true;
+}
+
+double ComputeScheduler::getBacklog() const {
+    double backlog = 0;
+    for (const Job &job : jobs) {
+        backlog += std::max(0.0, job.remaining);
+    }
+    return backlog;
+}
+
+double ComputeScheduler::nextCompletion() const {
+    if (jobs.empty() || capacity <= 0) {
+        return std::numeric_limits<double>::infinity();
+    }
+    int served = servedJob();
+    if (served != -1) {
+        return now + std::max(0.0, jobs[served].remaining) / capacity;
+    }
+    double least = jobs.front().remaining;
+    for (const Job &job : jobs) {
+        least = std::min(least, job.remaining);
+    }
+    return now + std::max(0.0, least) * jobs.size() / capacity;
+}
+
+void ComputeScheduler::advance(double time, std::vector<Completion> &completed) {
+    while (true) {
+        // Complete everything that is done, allowing for rounding in the
+        // rates; removal keeps the arrival order
+        size_t kept = 0;
+        for (size_t j = 0; j < jobs.size(); j++) {
+            const Job &job = jobs[j];
+            if (job.remaining <= job.work * 1e-9) {
+                double serviceTime = capacity > 0 ? job.work / capacity : 0;
+                completed.push_back(Completion{job.id, job.arrival, std::max(0.0, now - job.arrival - serviceTime)});
+            } else {
+                jobs[kept++] = job;
+            }
+        }
+        jobs.resize(kept);
+
+        double next = nextCompletion();
+        if (next > time) {
+            progress(time - now);
+            now = std::max(now, time);
+            return;
+        }
+        progress(next - now);
+        now = next;
+
+        // Land exactly on zero for the jobs finishing now
+        int served = servedJob();
+        if (served != -1) {
+            jobs[served].remaining = 0;
+        } else {
+            double least = jobs.front().remaining;
+            for (const Job &job : jobs) {
+                least = std::min(least, job.remaining);
+            }
+            for (Job &job : jobs) {
+                if (job.remaining <= least) {
+                    job.remaining = 0;
+                }
+            }
+        }
+    }
+}
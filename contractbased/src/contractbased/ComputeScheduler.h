@@ -0,0 +1,90 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+// Event-driven model of one computation resource shared by several tasks.
+//
+// The owner adds a job for every task it receives and calls advance() when
+// simulation time has moved, which completes the jobs that finished. As the
+// rate of a job depends on the other jobs, the owner keeps a single timer at
+// nextCompletion() and moves it whenever a job is added or completed.
+//
+// Policies:
+// - fifo: jobs run one at a time at full capacity, in arrival order
+// - ps: processor sharing, all jobs run at capacity / number of jobs
+// - edf: the job with the earliest deadline runs at full capacity,
+//   preempting the others; ties go to the earlier arrival
+class ComputeScheduler {
+public:
+    enum class Policy {
+        FIFO,
+        PROCESSOR_SHARING,
+        EDF
+    };
+
+    struct Completion {
+        long id;
+        double arrival;
+        double queueingDelay; // time in the system beyond the job's own service time
+    };
+
+private:
+    struct Job {
+        long id;
+        double arrival;
+        double deadline;
+        double work;
+        double remaining;
+    };
+
+    Policy policy;
+    double capacity;
+    std::vector<Job> jobs; // in arrival order
+    double now = 0;
+    double busyTime = 0;
+
+    // Index of the job served alone, -1 under processor sharing or when idle
+    int servedJob() const;
+
+    // Advances the jobs by time dt without completing any
+    void progress(double dt);
+
+public:
+    ComputeScheduler(Policy policy = Policy::PROCESSOR_SHARING, double capacity = 0);
+
+    // Accepts "fifo", "ps" or "edf"; returns false for any other name.
+    static bool parsePolicy(const std::string &name, Policy &policy);
+
+    // Takes effect from the current time; call advance() first.
+    void setCapacity(double capacity);
+
+    double getCapacity() const {
+        return capacity;
+    }
+
+    // Adds a job of work units (taskResource) arriving at time; call advance(time) first.
+    void add(long id, double time, double work, double deadline);
+
+    // Drops an unfinished job, for cancelled tasks; call advance() first.
+    // Returns false if there is no job with this id.
+    bool remove(long id);
+
+    // Moves the model to time and appends the jobs finished by then.
+    void advance(double time, std::vector<Completion> &completed);
+
+    // Time the next job finishes if nothing changes, infinity when idle or without capacity.
+    double nextCompletion() const;
+
+    int size() const {
+        return static_cast<int>(jobs.size());
+    }
+
+    // Work left in the present jobs
+    double getBacklog() const;
+
+    // Time during which at least one job was present
+    double getBusyTime() const {
+        return busyTime;
+    }
+};
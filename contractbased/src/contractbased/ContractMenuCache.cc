@@ -0,0 +1,101 @@
+#include "ContractMenuCache.h"
+
+#include <unistd.h>
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+ContractMenuCache::ContractMenuCache(const std::string &directory)
+    : directory(directory) {
+}
+
+std::string ContractMenuCache::key(const std::string &backend, const std::string &url, const ContractParameters &params) {
+    std::ostringstream out;
+    out.precision(17);
+    out << backend;
+    if (backend == "http") {
+        out << " url=" << url;
+    }
+    out
+        << " unitBenefit=" << params.unitBenefit
+        << " computationCapability=" << params.computationCapability
+        << " duration=" << params.duration
+        << " totalVehicles=" << params.totalVehicles
+        << " deltaMin=" << params.deltaMin
+        << " deltaMax=" << params.deltaMax
+        << " typeProbability=";
+    for (size_t i = 0; i < params.typeProbability.size(); i++) {
+        out << (i == 0 ? "" : ",") << params.typeProbability[i];
+    }
+    return out.str();
+}
+
+bool ContractMenuCache::load(const std::string &key, ContractMenu &menu) const {
+    std::ifstream in(path(key));
+    if (!in) {
+        return false;
+    }
+
+    std::string storedKey;
+    size_t size;
+    if (!std::getline(in, storedKey) || storedKey != key || !(in >> size)) {
+        return false;
+    }
+
+    ContractMenu stored;
+    stored.deltas.resize(size);
+    stored.pies.resize(size);
+    for (size_t i = 0; i < size; i++) {
+        if (!(in >> stored.deltas[i] >> stored.pies[i])) {
+            return false;
+        }
+    }
+
+    menu = stored;
+    return true;
+}
+
+bool ContractMenuCache::store(const std::string &key, const ContractMenu &menu) const {
+    // Write to a temporary file first so concurrent runs never read a partial
+    // entry; the pid keeps runs that share the directory apart
+    std::string target = path(key);
+    std::string temporary = target + ".tmp" + std::to_string(getpid()) + "." +
+                            std::to_string(std::chrono::steady_clock::now().time_since_epoch().count());
+    {
+        std::ofstream out(temporary);
+        if (!out) {
+            return false;
+        }
+        out.precision(17);
+        out << key << "\n" << menu.deltas.size() << "\n";
+        for (size_t i = 0; i < menu.deltas.size(); i++) {
+            out << menu.deltas[i] << " " << menu.pies[i] << "\n";
+        }
+        out.close();
+        if (!out) {
+            std::remove(temporary.c_str());
+            return false;
+        }
+    }
+    if (std::rename(temporary.c_str(), target.c_str()) != 0) {
+        std::remove(temporary.c_str());
+        return false;
+    }
+    return true;
+}
+
+std::string ContractMenuCache::path(const std::string &key) const {
+    // 64 bit FNV-1a
+    uint64_t hash = 14695981039346656037ULL;
+    for (unsigned char c : key) {
+        hash ^= c;
+        hash *= 1099511628211ULL;
+    }
+
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llx.menu", (unsigned long long) hash);
+    return directory + "/" + name;
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <string>
+
+#include "ContractSolver.h"
+
+// Content-addressed on-disk store of contract menus.
+//
+// Each menu lives in <directory>/<hash>.menu, where <hash> is the FNV-1a hash
+// of the canonical parameter key. The key itself is stored in the file as
+// well, so a hash collision is detected and treated as a miss.
+class ContractMenuCache {
+private:
+    std::string directory;
+
+public:
+    explicit ContractMenuCache(const std::string &directory);
+
+    // Canonical description of everything the menu depends on; url only
+    // counts for the "http" backend.
+    static std::string key(const std::string &backend, const std::string &url, const ContractParameters &params);
+
+    // Returns true and fills menu if an entry for key exists.
+    bool load(const std::string &key, ContractMenu &menu) const;
+
+    // Returns false if the entry could not be written.
+    bool store(const std::string &key, const ContractMenu &menu) const;
+
+private:
+    std::string path(const std::string &key) const;
+};
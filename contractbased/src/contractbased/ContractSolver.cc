@@ -0,0 +1,189 @@
+#include "ContractSolver.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+#include <curl/curl.h>
+#include <nlohmann/json.hpp>
+
+namespace {
+
+size_t writeCallback(void *contents, size_t size, size_t nmemb, std::string *s) {
+    size_t newLength = size * nmemb;
+    try {
+        s->append((char *) contents, newLength);
+    } catch (std::bad_alloc &e) {
+        // handle memory problem
+        return 0;
+    }
+    return newLength;
+}
+
+// Pool adjacent violators so that values become non-decreasing,
+// averaging each violating block with the given weights.
+void iron(std::vector<double> &values, const std::vector<double> &weights) {
+    std::vector<double> blockValue;
+    std::vector<double> blockWeight;
+    std::vector<size_t> blockSize;
+
+    for (size_t k = 0; k < values.size(); k++) {
+        blockValue.push_back(values[k]);
+        blockWeight.push_back(weights[k]);
+        blockSize.push_back(1);
+        while (blockValue.size() > 1 && blockValue[blockValue.size() - 2] > blockValue.back()) {
+            size_t last = blockValue.size() - 1;
+            double weight = blockWeight[last - 1] + blockWeight[last];
+            blockValue[last - 1] = (blockValue[last - 1] * blockWeight[last - 1] + blockValue[last] * blockWeight[last]) / weight;
+            blockWeight[last - 1] = weight;
+            blockSize[last - 1] += blockSize[last];
+            blockValue.pop_back();
+            blockWeight.pop_back();
+            blockSize.pop_back();
+        }
+    }
+
+    size_t k = 0;
+    for (size_t b = 0; b < blockValue.size(); b++) {
+        for (size_t i = 0; i < blockSize[b]; i++) {
+            values[k++] = blockValue[b];
+        }
+    }
+}
+
+} // namespace
+
+ContractMenu NativeContractSolver::solve(const ContractParameters &params) {
+    const std::vector<double> &p = params.typeProbability;
+    size_t types = p.size();
+    if (types == 0) {
+        throw std::runtime_error("typeProbability is empty");
+    }
+    if (params.deltaMin <= 0 || params.deltaMax < params.deltaMin) {
+        throw std::runtime_error("deltaMin and deltaMax must satisfy 0 < deltaMin <= deltaMax");
+    }
+    if (params.computationCapability <= 0 || params.totalVehicles <= 0) {
+        throw std::runtime_error("computationCapability and totalVehicles must be positive");
+    }
+
+    std::vector<double> theta(types);
+    for (size_t k = 0; k < types; k++) {
+        theta[k] = types == 1 ? params.deltaMax : params.deltaMin + (params.deltaMax - params.deltaMin) * k / (types - 1);
+    }
+
+    // Virtual cost coefficient: own cost plus the information rent paid to all higher types
+    std::vector<double> virtualCost(types);
+    double higherProbability = 0;
+    for (size_t k = types; k-- > 0;) {
+        virtualCost[k] = p[k] / theta[k];
+        if (k + 1 < types) {
+            virtualCost[k] += higherProbability * (1 / theta[k] - 1 / theta[k + 1]);
+        }
+        higherProbability += p[k];
+    }
+
+    auto resourceAt = [&](double marginalBenefit, size_t k) {
+        double upper = std::min(params.deltaMax, theta[k]);
+        if (virtualCost[k] <= 0) {
+            return upper;
+        }
+        return std::max(params.deltaMin, std::min(upper, p[k] * marginalBenefit / virtualCost[k]));
+    };
+
+    // Marginal benefit m = unitBenefit / (1 + S(m) / C) has a unique fixed point in [0, unitBenefit]
+    double low = 0;
+    double high = std::max(params.unitBenefit, 0.0);
+    for (int iteration = 0; iteration < 100; iteration++) {
+        double m = (low + high) / 2;
+        double pooled = 0;
+        for (size_t k = 0; k < types; k++) {
+            pooled += params.totalVehicles * p[k] * resourceAt(m, k);
+        }
+        if (m < params.unitBenefit / (1 + pooled / params.computationCapability)) {
+            low = m;
+        } else {
+            high = m;
+        }
+    }
+
+    ContractMenu menu;
+    menu.deltas.resize(types);
+    menu.pies.resize(types);
+    for (size_t k = 0; k < types; k++) {
+        menu.deltas[k] = resourceAt((low + high) / 2, k);
+    }
+    iron(menu.deltas, virtualCost);
+
+    for (size_t k = 0; k < types; k++) {
+        double cost = menu.deltas[k] * menu.deltas[k] / (2 * theta[k]);
+        if (k == 0) {
+            menu.pies[k] = cost;
+        } else {
+            double previousCost = menu.deltas[k - 1] * menu.deltas[k - 1] / (2 * theta[k]);
+            menu.pies[k] = menu.pies[k - 1] + cost - previousCost;
+        }
+    }
+
+    return menu;
+}
+
+HttpContractSolver::HttpContractSolver(const std::string &url)
+    : url(url) {
+}
+
+ContractMenu HttpContractSolver::solve(const ContractParameters &params) {
+    std::string readBuffer;
+
+    // Construct JSON payload
+    nlohmann::json data = {
+            {"unit_benefit",           params.unitBenefit},
+            {"computation_capability", params.computationCapability},
+            {"duration",               params.duration},
+            {"type_probability",       params.typeProbability},
+            {"total_vehicles",         params.totalVehicles},
+            {"delta_min",              params.deltaMin},
+            {"delta_max",              params.deltaMax}};
+    std::string jsonData = data.dump();
+
+    CURL *curl = curl_easy_init();
+    if (!curl) {
+        throw std::runtime_error("curl_easy_init() failed");
+    }
+
+    struct curl_slist *headers = nullptr;
+    headers = curl_slist_append(headers, "Content-Type: application/json"); // Add Content-Type header
+
+    curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
+    curl_easy_setopt(curl, CURLOPT_POSTFIELDS, jsonData.c_str());
+    curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE, jsonData.size());
+    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, writeCallback);
+    curl_easy_setopt(curl, CURLOPT_WRITEDATA, &readBuffer);
+    curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
+
+    CURLcode res = curl_easy_perform(curl);
+
+    curl_slist_free_all(headers);
+    curl_easy_cleanup(curl);
+
+    if (res != CURLE_OK) {
+        throw std::runtime_error(std::string("curl_easy_perform() failed: ") + curl_easy_strerror(res));
+    }
+
+    nlohmann::json responseJson = nlohmann::json::parse(readBuffer);
+    ContractMenu menu;
+    menu.deltas = responseJson["delta"].get<std::vector<double>>();
+    menu.pies = responseJson["pie"].get<std::vector<double>>();
+    if (menu.deltas.size() != menu.pies.size()) {
+        throw std::runtime_error("contract optimizer returned mismatching delta and pie sizes");
+    }
+    return menu;
+}
+
+ContractSolver *createContractSolver(const std::string &backend, const std::string &url) {
+    if (backend == "native") {
+        return new NativeContractSolver();
+    } else if (backend == "http") {
+        return new HttpContractSolver(url);
+    }
+    return nullptr;
+}
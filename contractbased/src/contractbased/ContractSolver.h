@@ -0,0 +1,62 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+struct ContractParameters {
+    double unitBenefit;
+    double computationCapability;
+    int duration;
+    std::vector<double> typeProbability;
+    int totalVehicles;
+    double deltaMin;
+    double deltaMax;
+};
+
+struct ContractMenu {
+    std::vector<double> deltas; // Required Computation Resource per type
+    std::vector<double> pies; // Corresponding Reward per type
+};
+
+class ContractSolver {
+public:
+    virtual ~ContractSolver() = default;
+
+    // Returns one (delta, pie) pair per entry of params.typeProbability.
+    // Throws std::runtime_error if no menu could be designed.
+    virtual ContractMenu solve(const ContractParameters &params) = 0;
+};
+
+// Designs the menu in-process.
+//
+// Vehicle type k has capability theta_k, evenly spaced on [deltaMin, deltaMax],
+// and pays delta^2 / (2 * theta_k) for sharing delta units of resource.
+// The RSU values the pooled resource S of all totalVehicles vehicles as
+// unitBenefit * computationCapability * log(1 + S / computationCapability).
+// The lowest type's IR constraint and all downward IC constraints bind, which
+// makes the problem separable per type once the marginal benefit of S is
+// fixed; that marginal benefit is found by bisection and non-monotone
+// resources are ironed so the menu stays incentive compatible.
+//
+// Benefit and costs are per unit of time, so the menu is that of a single
+// period and params.duration is not used; unlike the HTTP solver, which
+// passes it on to the optimizer, it does not change the rewards.
+class NativeContractSolver : public ContractSolver {
+public:
+    ContractMenu solve(const ContractParameters &params) override;
+};
+
+// Posts the parameters as JSON to an external optimizer and parses its
+// {"delta": [...], "pie": [...]} response.
+class HttpContractSolver : public ContractSolver {
+private:
+    std::string url;
+
+public:
+    explicit HttpContractSolver(const std::string &url);
+
+    ContractMenu solve(const ContractParameters &params) override;
+};
+
+// Returns a new solver for backend "native" or "http", or nullptr if the name is unknown.
+ContractSolver *createContractSolver(const std::string &backend, const std::string &url);
@@ -0,0 +1,87 @@
+#include "FleetRegistry.h"
+
+#include <cstdint>
+
+FleetRegistry::FleetRegistry() {
+    rehash(64);
+}
+
+size_t FleetRegistry::probeStart(int address) const {
+    // Fibonacci hashing; MAC addresses are often consecutive module ids
+    uint64_t hash = static_cast<uint64_t>(static_cast<uint32_t>(address)) * 0x9e3779b97f4a7c15ull;
+    return static_cast<size_t>(hash >> 32) & (table.size() - 1);
+}
+
+size_t FleetRegistry::findEntry(int address) const {
+    size_t mask = table.size() - 1;
+    size_t e = probeStart(address);
+    while (table[e].slot != -1 && table[e].address != address) {
+        e = (e + 1) & mask;
+    }
+    return e;
+}
+
+void FleetRegistry::rehash(size_t size) {
+    std::vector<Entry> old;
+    old.swap(table);
+    table.assign(size, Entry{0, -1});
+    for (const Entry &entry : old) {
+        if (entry.slot != -1) {
+            table[findEntry(entry.address)] = entry;
+        }
+    }
+}
+
+int FleetRegistry::acquire(int address) {
+    size_t e = findEntry(address);
+    if (table[e].slot != -1) {
+        return table[e].slot;
+    }
+
+    int slot;
+    if (!freeSlots.empty()) {
+        slot = freeSlots.back();
+        freeSlots.pop_back();
+    } else {
+        slot = slots++;
+    }
+    count++;
+
+    // Keep the load factor at most 1/2 so probe sequences stay short
+    if (2 * static_cast<size_t>(count) > table.size()) {
+        rehash(2 * table.size());
+        e = findEntry(address);
+    }
+    table[e] = Entry{address, slot};
+    return slot;
+}
+
+int FleetRegistry::find(int address) const {
+    return table[findEntry(address)].slot;
+}
+
+int FleetRegistry::release(int address) {
+    size_t mask = table.size() - 1;
+    size_t e = findEntry(address);
+    int slot = table[e].slot;
+    if (slot == -1) {
+        return -1;
+    }
+
+    // Backward shift deletion: move later entries of the cluster into the
+    // hole when their probe sequence passes it, so no tombstones are needed
+    size_t hole = e;
+    for (size_t next = (hole + 1) & mask; table[next].slot != -1; next = (next + 1) & mask) {
+        size_t start = probeStart(table[next].address);
+        if (((next - start) & mask) >= ((next - hole) & mask)) {
+            table[hole] = table[next];
+            hole = next;
+        }
+    }
+    table[hole].slot = -1;
+
+    freeSlots.push_back(slot);
+    count--;
+    return slot;
+}
+
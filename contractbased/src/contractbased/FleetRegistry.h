@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+// Maps vehicle MAC addresses to dense slots.
+//
+// Lookups go through an open addressing table with linear probing, so their
+// cost does not grow with the fleet. Slots of vehicles that left are reused
+// before new ones are added, which keeps the slot range as small as the
+// largest number of vehicles present at the same time. A slot therefore
+// stands for different vehicles over time; anything that may outlive a
+// vehicle's stay, such as an in-flight task, refers to it by address.
+class FleetRegistry {
+private:
+    struct Entry {
+        int address;
+        int slot; // -1 if the entry is empty
+    };
+
+    std::vector<Entry> table; // size is a power of two
+    int slots = 0; // handed out so far, free or not
+    std::vector<int> freeSlots;
+    int count = 0;
+
+    size_t probeStart(int address) const;
+    size_t findEntry(int address) const;
+    void rehash(size_t size);
+
+public:
+    FleetRegistry();
+
+    // Returns the slot of address, registering it in a free slot if needed.
+    int acquire(int address);
+
+    // Returns the slot of address, or -1 if it is not registered.
+    int find(int address) const;
+
+    // Frees the slot of address. Returns it, or -1 if address was not registered.
+    int release(int address);
+
+    // Number of slots handed out so far; every slot is below this.
+    int capacity() const {
+        return slots;
+    }
+};
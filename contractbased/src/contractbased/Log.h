@@ -0,0 +1,17 @@
+#pragma once
+
+#include <iostream>
+
+// Console trace of the contract and offloading pipeline. Results go through
+// the signals and @statistic declarations of the modules; these lines are
+// only for following a run by eye and are compiled out unless the build sets
+// a log level, e.g. CFLAGS += -DCONTRACTBASED_LOG_LEVEL=2 in makefrag.
+//
+// LOG_INFO (level 1): lost or rejected work and failed rounds
+// LOG_DEBUG (level 2): every message and task
+#ifndef CONTRACTBASED_LOG_LEVEL
+#define CONTRACTBASED_LOG_LEVEL 0
+#endif
+
+#define LOG_INFO if (CONTRACTBASED_LOG_LEVEL < 1) {} else std::cout
+#define LOG_DEBUG if (CONTRACTBASED_LOG_LEVEL < 2) {} else std::cout
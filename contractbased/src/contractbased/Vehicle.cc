@@ -1,13 +1,42 @@
 #include <omnetpp.h>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <list>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
 
 #include "veins/base/modules/BaseApplLayer.h"
 #include "veins/base/modules/BaseMacLayer.h"
+#include "veins/base/phyLayer/PhyToMacControlInfo.h"
+#include "veins/modules/phy/DeciderResult80211.h"
 #include "veins/modules/mobility/traci/TraCIMobility.h"
 #include "message_m.h"
+#include "ComputeScheduler.h"
+#include "Log.h"
 
 using namespace std;
 using namespace omnetpp;
 
+// Lane geometry of the SUMO network, looked up through TraCI by the first
+// vehicle that needs it and shared by all vehicles of the run
+struct LaneGeometry {
+    string runId; // run the cache was filled in, a new run may load another network
+    unordered_map<string, vector<veins::Coord>> shapes;
+    unordered_set<string> ids; // of the whole network, for later roads
+};
+
+static LaneGeometry &laneGeometry() {
+    static LaneGeometry geometry;
+    const char *runId = getEnvir()->getConfigEx()->getVariable(CFGVAR_RUNID);
+    if (geometry.runId != runId) {
+        geometry = LaneGeometry();
+        geometry.runId = runId;
+    }
+    return geometry;
+}
+
 class Vehicle : public veins::BaseApplLayer {
 private:
     double totalResource;
@@ -15,11 +44,62 @@ private:
     double taskResource;
     double delayConstraint;
     int baseStationAddress;
+    int macAddress = -1;
+
+    // The vehicle belongs to the RSU whose contract list it receives
+    // strongest and hands over to another one heard handoverMargin stronger
+    double baseStationPower; // dBm
+    double handoverMargin; // dB
+    bool taskPending = false; // metadata sent, assignment not yet received
     Contract selectedContract;
 
     SimTime taskAssignmentTime;
 
+    // Hedging: a second copy of the task is started at backupAddress if the
+    // first is not done after the delay the RSU sent with the assignment
+    int backupAddress = -1;
+    vector<int> taskExecutors; // addresses running a copy of the current attempt
+    bool taskCompleted = false;
+    cMessage *hedgeTimer = nullptr;
+    simsignal_t backupStartedSignal;
+
+    // Straggler handling: a task without a result by its timeout, counted from
+    // its request or its assignment, is requested again
+    double taskTimeoutFactor;
+    int maxTaskRetries;
+    int taskRetries = 0;
+    bool taskStarted = false; // an assignment of the current task arrived
+    cMessage *taskTimer = nullptr;
+    simsignal_t taskTimedOutSignal;
+    simsignal_t taskRetriedSignal;
+    simsignal_t taskAbandonedSignal;
+    simsignal_t taskDelaySignal;
+
     veins::TraCIMobility *mobility;
+    bool reportRoute;
+    double routeTurnCosine; // cosine of the heading change counted as a turn
+    double routeLookahead; // m
+
+    // Straight stretch of the route ahead, see straightHorizon()
+    enum class StretchEnd {
+        UNKNOWN, // the vehicle is not on its route, e.g. inside a junction
+        TURN, // stretchEnd is where the route turns
+        TURNING, // the vehicle is on a segment off its heading, which ends at stretchEnd
+        ROUTE_END, // stretchEnd is where the route ends
+        LOOKAHEAD // no turn within routeLookahead before stretchEnd
+    };
+    StretchEnd stretchKind = StretchEnd::UNKNOWN;
+    veins::Coord stretchEnd;
+    string stretchRoad; // road the stretch was looked up from
+
+    // Computation
+    ComputeScheduler computeScheduler;
+    cMessage *computeTimer = nullptr;
+    unordered_map<long, Task *> runningTasks; // by message id
+    vector<ComputeScheduler::Completion> completedTasks;
+    simtime_t computeStart;
+    simsignal_t computeQueueingDelaySignal;
+    simsignal_t computeUtilisationSignal;
 
 protected:
     virtual void initialize(int stage) override {
@@ -29,31 +109,80 @@ protected:
         taskDataSize = par("taskDataSize");
         taskResource = par("taskResource");
         delayConstraint = par("delayConstraint");
-        baseStationAddress = 0;
+        taskTimeoutFactor = par("taskTimeoutFactor");
+        maxTaskRetries = par("maxTaskRetries");
+        baseStationAddress = -1;
+        baseStationPower = -std::numeric_limits<double>::infinity();
+        handoverMargin = par("handoverMargin");
+        reportRoute = par("reportRoute");
+        routeTurnCosine = cos(par("routeTurnAngle").doubleValue() * M_PI / 180);
+        routeLookahead = par("routeLookahead");
         selectedContract = Contract();
 
         mobility = veins::TraCIMobilityAccess().get(getParentModule());
 
+        if (stage == 0) {
+            ComputeScheduler::Policy policy;
+            if (!ComputeScheduler::parsePolicy(par("computePolicy").stdstringValue(), policy)) {
+                throw cRuntimeError("Unknown compute policy \"%s\"", par("computePolicy").stringValue());
+            }
+            computeScheduler = ComputeScheduler(policy, 0);
+            computeTimer = new cMessage("computeTimer", COMPUTE_TIMER);
+            computeStart = simTime();
+            computeQueueingDelaySignal = registerSignal("computeQueueingDelay");
+            computeUtilisationSignal = registerSignal("computeUtilisation");
+            backupStartedSignal = registerSignal("backupStarted");
+            taskTimedOutSignal = registerSignal("taskTimedOut");
+            taskRetriedSignal = registerSignal("taskRetried");
+            taskAbandonedSignal = registerSignal("taskAbandoned");
+            taskDelaySignal = registerSignal("taskDelay");
+            hedgeTimer = new cMessage("startBackup", START_BACKUP);
+            taskTimer = new cMessage("taskTimeout", TASK_TIMEOUT);
+        }
+
         if (stage > 0)
-            cout << "Car initialized with id " << getParentModule()->getIndex() << " and address " << myAddress() <<
-                 " at " << simTime() << endl;
+            LOG_DEBUG << "Car initialized with id " << getParentModule()->getIndex() << " and address " << myAddress() <<
+                      " at " << simTime() << endl;
     }
 
     virtual void finish() override {
         BaseApplLayer::finish();
+        // Count the busy time since the last event; tasks finishing now are not
+        // reported, as no frames can be sent any more
+        completedTasks.clear();
+        computeScheduler.advance(simTime().dbl(), completedTasks);
+        if (simTime() > computeStart) {
+            emit(computeUtilisationSignal, computeScheduler.getBusyTime() / (simTime() - computeStart).dbl());
+        }
+    }
+
+public:
+    ~Vehicle() override {
+        cancelAndDelete(computeTimer);
+        cancelAndDelete(hedgeTimer);
+        cancelAndDelete(taskTimer);
+        for (auto &running : runningTasks) {
+            delete running.second;
+        }
     }
 
+protected:
+
     int getIndex() {
         return getParentModule()->getIndex();
     }
 
+    // Looked up once, the MAC address does not change
     int myAddress() {
-        auto *mac = static_cast<veins::BaseMacLayer *>(getParentModule()->getSubmodule("nic")->getSubmodule(
-                "mac1609_4"));
-        if (!mac) {
-            throw cRuntimeError("MAC module not found");
+        if (macAddress == -1) {
+            auto *mac = static_cast<veins::BaseMacLayer *>(getParentModule()->getSubmodule("nic")->getSubmodule(
+                    "mac1609_4"));
+            if (!mac) {
+                throw cRuntimeError("MAC module not found");
+            }
+            macAddress = static_cast<int>(mac->myMacAddr);
         }
-        return static_cast<int>(mac->myMacAddr);
+        return macAddress;
     }
 
     cMessage *populate(cMessage *msg, int recipient) {
@@ -64,6 +193,7 @@ protected:
         baseMessage->setChannelNumber(178);
         baseMessage->setPsid(-1);
         baseMessage->setUserPriority(7);
+        baseMessage->setBitLength(headerLength);
         return baseMessage;
     }
 
@@ -76,10 +206,113 @@ protected:
         double s = mobility->getSpeed();
         veins::Heading h = mobility->getHeading();
         baseMessage->setSpeed(veinsCoordToCoord(h.toCoord(s)));
+        baseMessage->setPositionTime(simTime());
+        if (reportRoute) {
+            baseMessage->setStraightHorizon(straightHorizon(s, h.toCoord()));
+        }
 
         return baseMessage;
     }
 
+    // Seconds until the vehicle turns off heading by more than routeTurnAngle,
+    // following the lane shapes of its SUMO route; infinity if it does not
+    // within routeLookahead, -1 if its position on the route is unknown
+    double straightHorizon(double speed, veins::Coord heading) {
+        if (speed <= 0) {
+            return std::numeric_limits<double>::infinity();
+        }
+        veins::Coord position = mobility->getPositionAt(simTime());
+        double remaining = position.distance(stretchEnd);
+        bool passed = stretchKind != StretchEnd::UNKNOWN && (stretchEnd - position) * heading <= 0;
+        if (mobility->getRoadId() != stretchRoad || passed ||
+            (stretchKind == StretchEnd::LOOKAHEAD && remaining < routeLookahead / 2)) {
+            findStretch(heading);
+            remaining = position.distance(stretchEnd);
+        }
+        switch (stretchKind) {
+            case StretchEnd::UNKNOWN:
+                return -1;
+            case StretchEnd::TURNING:
+                return 0;
+            case StretchEnd::LOOKAHEAD:
+                return std::numeric_limits<double>::infinity();
+            default:
+                // The stretch deviates from a line by less than the turn angle,
+                // so the straight distance is close to the one along the lanes
+                return remaining / speed;
+        }
+    }
+
+    // Follows the route from the vehicle's lane to where the stretch of its
+    // current heading ends. Queries TraCI, so straightHorizon() only calls it
+    // when the vehicle entered another road or got near the end of the last
+    // stretch; a reroute by SUMO is picked up on the next road.
+    void findStretch(veins::Coord heading) {
+        veins::TraCICommandInterface::Vehicle *vehicle = mobility->getVehicleCommandInterface();
+        stretchRoad = mobility->getRoadId();
+        stretchKind = StretchEnd::UNKNOWN;
+        stretchEnd = mobility->getPositionAt(simTime());
+
+        // The current lane is exact; later roads are followed on the same
+        // lane index where they have it, as lane changes are not known ahead
+        string lane = vehicle->getLaneId();
+        string laneIndex = lane.substr(lane.rfind('_') + 1);
+        list<string> lanes{lane};
+        list<string> route = vehicle->getPlannedRoadIds();
+        auto road = find(route.begin(), route.end(), stretchRoad);
+        bool onRoute = road != route.end();
+        if (onRoute) {
+            for (++road; road != route.end(); ++road) {
+                lanes.push_back(laneExists(*road + "_" + laneIndex) ? *road + "_" + laneIndex : *road + "_0");
+            }
+        }
+
+        // Distance along the lanes, negative behind the vehicle
+        double distance = -vehicle->getLanePosition();
+        for (const string &id : lanes) {
+            const vector<veins::Coord> &shape = laneShape(id);
+            for (size_t i = 1; i < shape.size(); i++) {
+                veins::Coord segment = shape[i] - shape[i - 1];
+                double length = segment.length();
+                if (length == 0) {
+                    continue;
+                }
+                if (distance + length > 0 && segment * heading < routeTurnCosine * length) {
+                    stretchKind = distance > 0 ? StretchEnd::TURN : StretchEnd::TURNING;
+                    stretchEnd = distance > 0 ? shape[i - 1] : shape[i];
+                    return;
+                }
+                distance += length;
+                stretchEnd = shape[i];
+                if (distance > routeLookahead) {
+                    stretchKind = StretchEnd::LOOKAHEAD;
+                    return;
+                }
+            }
+        }
+        stretchKind = onRoute ? StretchEnd::ROUTE_END : StretchEnd::UNKNOWN;
+    }
+
+    // Lane shapes are static for a run, so each is queried once
+    const vector<veins::Coord> &laneShape(const string &id) {
+        auto &shapes = laneGeometry().shapes;
+        auto cached = shapes.find(id);
+        if (cached == shapes.end()) {
+            list<veins::Coord> shape = mobility->getCommandInterface()->lane(id).getShape();
+            cached = shapes.emplace(id, vector<veins::Coord>(shape.begin(), shape.end())).first;
+        }
+        return cached->second;
+    }
+
+    bool laneExists(const string &id) {
+        auto &ids = laneGeometry().ids;
+        if (ids.empty()) {
+            list<string> laneIds = mobility->getCommandInterface()->getLaneIds();
+            ids.insert(laneIds.begin(), laneIds.end());
+        }
+        return ids.count(id) > 0;
+    }
+
     bool isForMe(cMessage *msg) {
         BaseMessage *baseMessage = check_and_cast<BaseMessage *>(msg);
         return baseMessage->getRecipient() == myAddress() || baseMessage->getRecipient() == -1;
@@ -94,26 +327,47 @@ protected:
     }
 
     virtual void handleSelfMsg(cMessage *msg) override {
-        if (msg->isName("prepareTaskMetadata")) {
-            prepareTaskMetadata();
-        } else if (msg->isName("handleTask")) {
-            finishTask(msg);
+        switch (msg->getKind()) {
+            case PREPARE_TASK_METADATA:
+                prepareTaskMetadata();
+                delete msg;
+                break;
+            case COMPUTE_TIMER:
+                updateCompute();
+                scheduleComputeTimer();
+                break;
+            case START_BACKUP:
+                startBackup();
+                break;
+            case TASK_TIMEOUT:
+                handleTaskTimeout();
+                break;
         }
     }
 
     virtual void handleLowerMsg(cMessage *msg) override {
         if (isForMe(msg)) {
-            // check if cMessage is of type ContractList
-            if (msg->isName("processContractList")) {
-                handleContractList(msg);
-            } else if (msg->isName("handleTask")) {
-                handleTask(msg);
-            } else if (msg->isName("handleTaskAssignment")) {
-                handleTaskAssignment(msg);
-            } else if (msg->isName("handleTaskCompletion")) {
-                handleTaskCompletion(msg);
-            } else {
-                cout << "Vehicle: " << myAddress() << " received unknown message" << endl;
+            switch (msg->getKind()) {
+                case CONTRACT_LIST:
+                    handleContractList(msg);
+                    break;
+                case TASK:
+                    handleTask(msg);
+                    return; // kept until computed
+                case TASK_ASSIGNMENT:
+                    handleTaskAssignment(msg);
+                    break;
+                case TASK_ASSIGNMENT_BATCH:
+                    handleTaskAssignmentBatch(msg);
+                    break;
+                case TASK_COMPLETION:
+                    handleTaskCompletion(msg);
+                    break;
+                case TASK_CANCEL:
+                    handleTaskCancel(msg);
+                    break;
+                default:
+                    LOG_INFO << "Vehicle: " << myAddress() << " received unknown message" << endl;
             }
         }
 
@@ -121,16 +375,38 @@ protected:
     }
 
     virtual void handleLowerControl(cMessage *msg) override {
-        cout << "Vehicle: " << getIndex() << " received control message with name " << msg->getName() << endl;
+        LOG_DEBUG << "Vehicle: " << getIndex() << " received control message with name " << msg->getName() << endl;
         delete msg;
     }
 
     void handleContractList(cMessage *msg) {
         // cast cMessage to ContractList
-        EV << "Vehicle: " << myAddress() << " with resource: " << totalResource << " received contract list" << endl;
         ContractList *contractList = check_and_cast<ContractList *>(msg);
+        double power = check_and_cast<veins::DeciderResult80211 *>(
+                veins::PhyToMacControlInfo::getDeciderResult(msg))->getRecvPower_dBm();
+        if (contractList->getSender() == baseStationAddress) {
+            baseStationPower = power;
+            return;
+        }
+        if (baseStationAddress != -1 && power < baseStationPower + handoverMargin) {
+            return;
+        }
+
+        // Associate, leaving the current RSU if any; hosted and running tasks carry on
+        bool handover = baseStationAddress != -1;
+        if (handover) {
+            LOG_DEBUG << "Vehicle: " << getIndex() << " hands over from " << baseStationAddress << " to "
+                      << contractList->getSender() << endl;
+            Disassociate *disassociate = new Disassociate("disassociate", DISASSOCIATE);
+            populate(disassociate, baseStationAddress);
+            sendDown(disassociate);
+        }
         baseStationAddress = contractList->getSender();
+        baseStationPower = power;
+        EV << "Vehicle: " << myAddress() << " with resource: " << totalResource << " received contract list" << endl;
 
+        // Every RSU designs its own menu, so the contract is chosen anew
+        selectedContract = Contract();
         int bestContractIndex = -1;
         for (int i = 0; i < contractList->getContractsArraySize(); i++) {
             // get contract from contractList
@@ -141,7 +417,11 @@ protected:
                 bestContractIndex = i;
             }
         }
-        ContractChoice *contractChoice = new ContractChoice("chooseContract");
+        updateCompute();
+        computeScheduler.setCapacity(selectedContract.getResource());
+        scheduleComputeTimer();
+
+        ContractChoice *contractChoice = new ContractChoice("chooseContract", CONTRACT_CHOICE);
         contractChoice->setType(bestContractIndex);
         contractChoice->setIndex(getIndex());
 
@@ -152,19 +432,41 @@ protected:
 
         populateGeo(contractChoice);
         populate(contractChoice, baseStationAddress);
+        if (handover) {
+            // A task still waiting for its assignment moves to the new RSU
+            if (taskPending) {
+                attachTask(contractChoice);
+            }
+        } else if (!par("piggybackTaskMetadata").boolValue()) {
+            cMessage *prepTaskMetadataMsg = new cMessage("prepareTaskMetadata", PREPARE_TASK_METADATA);
+            scheduleAt(simTime() + uniform(0.1, 0.3), prepTaskMetadataMsg);
+        } else if (totalResource <= 0) {
+            attachTask(contractChoice);
+        }
         sendDelayedDown(contractChoice, uniform(0, 0.1));
+    }
 
-        cMessage *prepTaskMetadataMsg = new cMessage("prepareTaskMetadata");
-        scheduleAt(simTime() + uniform(0.1, 0.3), prepTaskMetadataMsg);
+    void attachTask(ContractChoice *contractChoice) {
+        contractChoice->setHasTask(true);
+        contractChoice->setTaskResource(taskResource);
+        contractChoice->setTaskDataSize(taskDataSize);
+        contractChoice->setDelayConstraint(delayConstraint);
+        taskPending = true;
+        armTaskTimer();
     }
 
     void prepareTaskMetadata() {
         if (totalResource > 0)
             return;
 
-        cout << "Vehicle: " << getIndex() << " with resource: " << totalResource << " preparing task metadata" << endl;
+        LOG_DEBUG << "Vehicle: " << getIndex() << " with resource: " << totalResource << " preparing task metadata" << endl;
+        taskRetries = 0;
+        taskStarted = false;
+        sendTaskMetadata();
+    }
 
-        TaskMetadata *taskMetadata = new TaskMetadata("handleTaskMetadata");
+    void sendTaskMetadata() {
+        TaskMetadata *taskMetadata = new TaskMetadata("handleTaskMetadata", TASK_METADATA);
         taskMetadata->setTaskResource(taskResource);
         taskMetadata->setTaskDataSize(taskDataSize);
         taskMetadata->setDelayConstraint(delayConstraint);
@@ -172,62 +474,199 @@ protected:
         populateGeo(taskMetadata);
         populate(taskMetadata, baseStationAddress);
         sendDown(taskMetadata);
+        taskPending = true;
+        armTaskTimer();
+    }
+
+    // Bounds the wait for an assignment as well as for the result, so a lost
+    // TaskMetadata or TaskAssignment is requested again
+    void armTaskTimer() {
+        cancelEvent(taskTimer);
+        if (taskTimeoutFactor > 0) {
+            scheduleAt(simTime() + taskTimeoutFactor * delayConstraint, taskTimer);
+        }
     }
 
     void handleTaskAssignment(cMessage *msg) {
         TaskAssignment *task = check_and_cast<TaskAssignment *>(msg);
-        cout << "Vehicle: " << getIndex() << " will assign it's task to " << task->getFogNodeId() <<
-             " with price " << task->getPrice() << " with resource " << taskResource << " data size " << taskDataSize <<
-             " at " << simTime() << endl;
+        LOG_DEBUG << "Vehicle: " << getIndex() << " will assign it's task to " << task->getFogNodeId() <<
+                  " with price " << task->getPrice() << " with resource " << taskResource << " data size " << taskDataSize <<
+                  " at " << simTime() << endl;
 
-        offloadTask(task->getAddress());
+        startTask(task->getAddress(), task->getBackupAddress(), task->getHedgeDelay());
     }
 
-    void offloadTask(int address) {
-        string *taskData = new string(taskDataSize, 'a');
-        taskAssignmentTime = simTime();
+    void handleTaskAssignmentBatch(cMessage *msg) {
+        TaskAssignmentBatch *batch = check_and_cast<TaskAssignmentBatch *>(msg);
+        int address = myAddress();
+        for (size_t e = 0; e < batch->getEntriesArraySize(); e++) {
+            const AssignmentEntry &entry = batch->getEntries(e);
+            if (entry.requester != address) {
+                continue;
+            }
+            LOG_DEBUG << "Vehicle: " << getIndex() << " will assign it's task to " << entry.fogNodeId <<
+                      " with price " << entry.price << " with resource " << taskResource << " data size " << taskDataSize <<
+                      " at " << simTime() << endl;
+
+            startTask(entry.address, entry.backupAddress, entry.hedgeDelay);
+            return;
+        }
+    }
+
+    void startTask(int address, int backup, simtime_t hedgeDelay) {
+        if (!taskPending) {
+            return; // a duplicate, or the task was completed or abandoned meanwhile
+        }
+        taskPending = false;
+        // Retries keep the original assignment time, so the delay covers them
+        if (!taskStarted) {
+            taskStarted = true;
+            taskAssignmentTime = simTime();
+        }
+        backupAddress = backup;
+        taskExecutors.assign(1, address);
+        taskCompleted = false;
+        cancelEvent(hedgeTimer);
+        if (backupAddress != -1) {
+            scheduleAt(simTime() + hedgeDelay, hedgeTimer);
+        }
+        armTaskTimer();
+
+        offloadTask(address);
+    }
+
+    void startBackup() {
+        LOG_INFO << "Vehicle: " << getIndex() << " task is late, starting its backup at " << backupAddress << endl;
+        taskExecutors.push_back(backupAddress);
+        emit(backupStartedSignal, 1);
+        offloadTask(backupAddress);
+    }
 
-        Task *task = new Task("handleTask");
-        task->setTaskData(taskData->c_str());
+    void offloadTask(int address) {
+        Task *task = new Task("handleTask", TASK);
         task->setTaskResource(taskResource);
+        task->setBaseStation(baseStationAddress);
+        task->setDeadline(taskAssignmentTime + delayConstraint);
 
         populate(task, address);
+        // the input data is only modelled by its length, which the MAC turns into airtime
+        task->addByteLength(static_cast<int64_t>(taskDataSize));
         sendDown(task);
     }
 
+
     void handleTask(cMessage *msg) {
         Task *task = check_and_cast<Task *>(msg);
+        LOG_DEBUG << "Vehicle: " << getIndex() << " received task with resource " << task->getTaskResource() <<
+                  " at " << simTime() << endl;
 
-        // sleep for sharedResource / taskResource
-        simtime_t sleepTime = task->getTaskResource() / selectedContract.getResource();
+        updateCompute();
+        computeScheduler.add(task->getId(), simTime().dbl(), task->getTaskResource(), task->getDeadline().dbl());
+        runningTasks[task->getId()] = task;
+        scheduleComputeTimer();
+    }
 
-        cout << "Vehicle: " << getIndex() << " received task with resource " << task->getTaskResource() <<
-             " at " << simTime() << " and sleeping for " << sleepTime << endl;
+    // Completes the tasks finished by now
+    void updateCompute() {
+        completedTasks.clear();
+        computeScheduler.advance(simTime().dbl(), completedTasks);
+        for (const ComputeScheduler::Completion &completion : completedTasks) {
+            Task *task = runningTasks[completion.id];
+            runningTasks.erase(completion.id);
+            emit(computeQueueingDelaySignal, completion.queueingDelay);
+            finishTask(task);
+            delete task;
+        }
+    }
 
-        scheduleAt(simTime() + sleepTime, task->dup());
+    void scheduleComputeTimer() {
+        cancelEvent(computeTimer);
+        double next = computeScheduler.nextCompletion();
+        if (next != std::numeric_limits<double>::infinity()) {
+            scheduleAt(std::max(simTime(), SimTime(next)), computeTimer);
+        }
     }
 
-    void finishTask(cMessage *msg) {
-        Task *task = check_and_cast<Task *>(msg);
-        cout << "Vehicle: " << getIndex() << " finished task with resource " << task->getTaskResource() <<
-             " at " << simTime() << endl;
+    void finishTask(Task *task) {
+        LOG_DEBUG << "Vehicle: " << getIndex() << " finished task with resource " << task->getTaskResource() <<
+                  " at " << simTime() << endl;
 
         // send task completion to base station
-        TaskCompletion *taskCompletion = new TaskCompletion("handleTaskCompletion");
+        TaskCompletion *taskCompletion = new TaskCompletion("handleTaskCompletion", TASK_COMPLETION);
         taskCompletion->setResult("Task completed");
+        taskCompletion->setRequester(task->getSender());
+        taskCompletion->setExecutor(myAddress());
 
-        populate(taskCompletion, baseStationAddress);
+        populate(taskCompletion, task->getBaseStation());
         sendDown(taskCompletion);
     }
 
     void handleTaskCompletion(cMessage *msg) {
         TaskCompletion *taskCompletion = check_and_cast<TaskCompletion *>(msg);
-        cout << "Vehicle: " << getIndex() << " received task completion with result " << taskCompletion->getResult()
-             << " at " << simTime() << endl;
+        LOG_DEBUG << "Vehicle: " << getIndex() << " received task completion with result " << taskCompletion->getResult()
+                  << " at " << simTime() << endl;
+        if (taskCompleted) {
+            return; // the other copy of a hedged task
+        }
+        taskCompleted = true;
+        taskPending = false;
+        cancelEvent(hedgeTimer);
+        cancelEvent(taskTimer);
+        // The result may also come from an attempt that already timed out,
+        // then every copy of the retry is stopped
+        for (int executor : taskExecutors) {
+            if (executor != taskCompletion->getExecutor()) {
+                sendTaskCancel(executor);
+            }
+        }
+        taskExecutors.clear();
 
         SimTime delay = simTime() - taskAssignmentTime;
-        cout << "Vehicle: " << getIndex() << " task delay: " << delay << endl;
-        cerr << delay << endl;
+        LOG_DEBUG << "Vehicle: " << getIndex() << " task delay: " << delay << endl;
+        emit(taskDelaySignal, delay);
+    }
+
+    void sendTaskCancel(int address) {
+        TaskCancel *cancel = new TaskCancel("handleTaskCancel", TASK_CANCEL);
+        populate(cancel, address);
+        sendDown(cancel);
+    }
+
+    // The request, the assignment or the result was lost or is too late: stop
+    // the running copies and ask the RSU to match the task again, up to
+    // maxTaskRetries times
+    void handleTaskTimeout() {
+        emit(taskTimedOutSignal, 1);
+        cancelEvent(hedgeTimer);
+        for (int executor : taskExecutors) {
+            sendTaskCancel(executor);
+        }
+        taskExecutors.clear();
+        if (taskRetries >= maxTaskRetries) {
+            LOG_INFO << "Vehicle: " << getIndex() << " abandoned its task after " << taskRetries << " retries" << endl;
+            taskCompleted = true;
+            taskPending = false;
+            emit(taskAbandonedSignal, 1);
+            return;
+        }
+        LOG_INFO << "Vehicle: " << getIndex() << " task timed out, requesting a new assignment" << endl;
+        taskRetries++;
+        emit(taskRetriedSignal, 1);
+        sendTaskMetadata();
+    }
+
+    void handleTaskCancel(cMessage *msg) {
+        int requester = check_and_cast<TaskCancel *>(msg)->getSender();
+        updateCompute();
+        for (auto running = runningTasks.begin(); running != runningTasks.end(); ++running) {
+            if (running->second->getSender() == requester) {
+                computeScheduler.remove(running->first);
+                delete running->second;
+                runningTasks.erase(running);
+                break;
+            }
+        }
+        scheduleComputeTimer();
     }
 };
 
@@ -0,0 +1,262 @@
+#include "AuctionMatcher.h"
+
+#include <algorithm>
+#include <limits>
+#include <utility>
+
+AuctionMatcher::AuctionMatcher(double epsilonScale, double epsilonFinal, int maxIterations)
+    : epsilonScale(epsilonScale)
+    , epsilonFinal(epsilonFinal)
+    , maxIterations(maxIterations) {
+}
+
+Matcher *AuctionMatcher::clone() const {
+    return new AuctionMatcher(epsilonScale, epsilonFinal, maxIterations);
+}
+
+MatchResult AuctionMatcher::solve(MatchingProblem &problem, const FeasibilityMatrix &feasibility) {
+    int numVehicles = problem.size();
+
+    MatchResult result;
+    std::vector<int> &assignment = result.assignment;
+    assignment.assign(numVehicles, -1);
+
+    // Requesters reach their fog nodes through the rows of the feasibility
+    // matrix; the transposed entries give the requesters of each fog node
+    size_t entries = feasibility.entries();
+    int *requesters = workspace.allocate<int>(feasibility.rows());
+    int *rowOf = workspace.allocate<int>(numVehicles, -1);
+    double *value = workspace.allocate<double>(entries);
+    size_t *bidderStart = workspace.allocate<size_t>(numVehicles + 1, 0);
+    int *bidderRow = workspace.allocate<int>(entries);
+    double *bidderValue = workspace.allocate<double>(entries);
+    int *nodes = workspace.allocate<int>(numVehicles);
+    int nodeCount = 0;
+    double maxValue = 0;
+    for (int r = 0; r < feasibility.rows(); r++) {
+        requesters[r] = feasibility.requester(r);
+        rowOf[requesters[r]] = r;
+        for (size_t k = feasibility.rowBegin(r); k < feasibility.rowEnd(r); k++) {
+            value[k] = 1 / feasibility.totalTime(k);
+            maxValue = std::max(maxValue, value[k]);
+            if (bidderStart[feasibility.node(k) + 1]++ == 0) {
+                nodes[nodeCount++] = feasibility.node(k);
+            }
+        }
+    }
+    for (int j = 0; j < numVehicles; j++) {
+        bidderStart[j + 1] += bidderStart[j];
+    }
+    size_t *bidderFill = workspace.allocate<size_t>(numVehicles);
+    std::copy(bidderStart, bidderStart + numVehicles, bidderFill);
+    for (int r = 0; r < feasibility.rows(); r++) {
+        for (size_t k = feasibility.rowBegin(r); k < feasibility.rowEnd(r); k++) {
+            size_t slot = bidderFill[feasibility.node(k)]++;
+            bidderRow[slot] = r;
+            bidderValue[slot] = value[k];
+        }
+    }
+
+    double *price = workspace.allocate<double>(numVehicles, 0.0);
+    double *profit = workspace.allocate<double>(numVehicles, 0.0);
+    int *owner = workspace.allocate<int>(numVehicles, -1);
+    bool warm = false;
+    if (warmStart) {
+        for (int j = 0; j < numVehicles; j++) {
+            price[j] = problem.vehicles[j].taskPrice;
+            warm = warm || price[j] > 0;
+        }
+
+        // Keep previous pairs that did not change; the epsilon-CS check of the
+        // first phase frees those that are no longer good enough
+        for (int r = 0; r < feasibility.rows(); r++) {
+            int i = requesters[r];
+            int j = previousAssignment[i];
+            if (j == i) {
+                assignment[i] = i;
+                warm = true;
+                continue;
+            }
+            if (j == -1 || owner[j] != -1) {
+                continue;
+            }
+            for (size_t k = feasibility.rowBegin(r); k < feasibility.rowEnd(r); k++) {
+                if (feasibility.node(k) == j && feasibility.totalTime(k) == previousTotalTime[i]) {
+                    assignment[i] = j;
+                    owner[j] = i;
+                    profit[i] = value[k] - price[j];
+                    warm = true;
+                    break;
+                }
+            }
+        }
+    }
+    double *bestBid = workspace.allocate<double>(numVehicles, 0.0);
+    double *bestBidValue = workspace.allocate<double>(numVehicles, 0.0);
+    int *bestBidder = workspace.allocate<int>(numVehicles, -1);
+    int *bidders = workspace.allocate<int>(feasibility.rows());
+    int *nextBidders = workspace.allocate<int>(feasibility.rows());
+    int *biddenNodes = workspace.allocate<int>(numVehicles);
+    int *unassignedNodes = workspace.allocate<int>(numVehicles);
+    int bidderCount = 0;
+    int nextBidderCount = 0;
+    int biddenNodeCount = 0;
+    int unassignedNodeCount = 0;
+
+    // Net value of the best and second-best option of requester i, the RSU being worth 0
+    auto bestOptions = [&](int i, int &bestNode, double &bestValue, double &best, double &secondBest) {
+        best = 0;
+        secondBest = 0;
+        bestValue = 0;
+        bestNode = i;
+        int r = rowOf[i];
+        for (size_t k = feasibility.rowBegin(r); k < feasibility.rowEnd(r); k++) {
+            double net = value[k] - price[feasibility.node(k)];
+            if (net > best) {
+                secondBest = best;
+                best = net;
+                bestValue = value[k];
+                bestNode = feasibility.node(k);
+            } else if (net > secondBest) {
+                secondBest = net;
+            }
+        }
+    };
+
+    double epsilonMin = maxValue * epsilonFinal;
+    double epsilon = std::max(warm ? epsilonMin * epsilonScale : maxValue / epsilonScale, epsilonMin);
+    int iterations = 0;
+    while (true) {
+        // Requesters that are unassigned or violate epsilon-complementary slackness bid again
+        bidderCount = 0;
+        for (int r = 0; r < feasibility.rows(); r++) {
+            int i = requesters[r];
+            int bestNode;
+            double bestValue, best, secondBest;
+            bestOptions(i, bestNode, bestValue, best, secondBest);
+            if (assignment[i] == -1 || best - profit[i] > epsilon * (1 + 1e-9)) {
+                if (assignment[i] != -1 && assignment[i] != i) {
+                    owner[assignment[i]] = -1;
+                }
+                assignment[i] = -1;
+                bidders[bidderCount++] = i;
+            }
+        }
+
+        // Forward auction: requesters bid for fog nodes until everyone is assigned
+        while (bidderCount > 0) {
+            if (++iterations > maxIterations) {
+                result.iterations = iterations;
+                return result;
+            }
+
+            biddenNodeCount = 0;
+            for (int b = 0; b < bidderCount; b++) {
+                int i = bidders[b];
+                int bestNode;
+                double bestValue, best, secondBest;
+                bestOptions(i, bestNode, bestValue, best, secondBest);
+                if (bestNode == i) {
+                    assignment[i] = i;
+                    profit[i] = 0;
+                    continue;
+                }
+
+                // Raise the price by the margin over the second-best option
+                double bid = price[bestNode] + best - secondBest + epsilon;
+                if (bestBidder[bestNode] == -1) {
+                    biddenNodes[biddenNodeCount++] = bestNode;
+                }
+                if (bestBidder[bestNode] == -1 || bid > bestBid[bestNode]) {
+                    bestBid[bestNode] = bid;
+                    bestBidValue[bestNode] = bestValue;
+                    bestBidder[bestNode] = i;
+                }
+            }
+
+            // Outbid holders and losing bidders bid again
+            nextBidderCount = 0;
+            for (int b = 0; b < biddenNodeCount; b++) {
+                int j = biddenNodes[b];
+                if (owner[j] != -1) {
+                    assignment[owner[j]] = -1;
+                    nextBidders[nextBidderCount++] = owner[j];
+                }
+                owner[j] = bestBidder[j];
+                assignment[owner[j]] = j;
+                price[j] = bestBid[j];
+                profit[owner[j]] = bestBidValue[j] - price[j];
+                bestBidder[j] = -1;
+            }
+            for (int b = 0; b < bidderCount; b++) {
+                if (assignment[bidders[b]] == -1) {
+                    nextBidders[nextBidderCount++] = bidders[b];
+                }
+            }
+            std::swap(bidders, nextBidders);
+            bidderCount = nextBidderCount;
+        }
+
+        // Reverse auction: fog nodes left without a task lower their price
+        // and pull in their best requester until all of them are free again
+        unassignedNodeCount = 0;
+        for (int n = 0; n < nodeCount; n++) {
+            if (owner[nodes[n]] == -1 && price[nodes[n]] > 0) {
+                unassignedNodes[unassignedNodeCount++] = nodes[n];
+            }
+        }
+        while (unassignedNodeCount > 0) {
+            int j = unassignedNodes[--unassignedNodeCount];
+            if (++iterations > maxIterations) {
+                result.iterations = iterations;
+                return result;
+            }
+
+            int bestRequester = -1;
+            double bestValue = 0;
+            double best = -std::numeric_limits<double>::infinity();
+            double secondBest = -std::numeric_limits<double>::infinity();
+            for (size_t k = bidderStart[j]; k < bidderStart[j + 1]; k++) {
+                int i = requesters[bidderRow[k]];
+                double net = bidderValue[k] - profit[i];
+                if (net > best) {
+                    secondBest = best;
+                    best = net;
+                    bestValue = bidderValue[k];
+                    bestRequester = i;
+                } else if (net > secondBest) {
+                    secondBest = net;
+                }
+            }
+            if (best <= epsilon) {
+                price[j] = 0;
+                continue;
+            }
+
+            price[j] = std::max(0.0, secondBest - epsilon);
+            int previous = assignment[bestRequester];
+            if (previous != bestRequester) {
+                owner[previous] = -1;
+                if (price[previous] > 0) {
+                    unassignedNodes[unassignedNodeCount++] = previous;
+                }
+            }
+            owner[j] = bestRequester;
+            assignment[bestRequester] = j;
+            profit[bestRequester] = bestValue - price[j];
+        }
+
+        if (epsilon <= epsilonMin) {
+            break;
+        }
+        epsilon = std::max(epsilon / epsilonScale, epsilonMin);
+    }
+
+    for (int j = 0; j < numVehicles; j++) {
+        problem.vehicles[j].taskPrice = price[j];
+    }
+
+    result.success = true;
+    result.iterations = iterations;
+    return result;
+}
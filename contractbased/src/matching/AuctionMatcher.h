@@ -0,0 +1,31 @@
+#pragma once
+
+#include "Matcher.h"
+
+// Epsilon-scaling forward auction (Bertsekas).
+//
+// Requesters value fog node j at 1 / totalTime and the RSU at 0; the RSU can
+// serve any number of tasks for free, fog nodes one task each. In every round
+// all unassigned requesters bid on their best node, raising its price by the
+// gap between their best and second-best net value plus epsilon, and each
+// node goes to its highest bidder. Epsilon starts at a fraction of the largest
+// value and shrinks by epsilonScale per phase, keeping the prices of the
+// previous phase, until it reaches epsilonFinal times the largest value.
+//
+// A warm started solve begins from the prices in the problem and keeps the
+// previous assignment of every requester whose node is still feasible at the
+// same value; only the other requesters bid, and the coarse phases are
+// skipped since the prices are already close.
+class AuctionMatcher : public Matcher {
+private:
+    double epsilonScale;
+    double epsilonFinal;
+    int maxIterations;
+
+public:
+    explicit AuctionMatcher(double epsilonScale = 4, double epsilonFinal = 1e-6, int maxIterations = 100000);
+
+protected:
+    MatchResult solve(MatchingProblem &problem, const FeasibilityMatrix &feasibility) override;
+    Matcher *clone() const override;
+};
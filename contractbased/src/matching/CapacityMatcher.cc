@@ -0,0 +1,169 @@
+#include "CapacityMatcher.h"
+
+#include <algorithm>
+
+MatchResult CapacityMatcher::solve(MatchingProblem &problem, const FeasibilityMatrix &feasibility) {
+    int numVehicles = problem.size();
+    int rows = feasibility.rows();
+    size_t entries = feasibility.entries();
+
+    MatchResult result;
+    std::vector<int> &assignment = result.assignment;
+    assignment.assign(numVehicles, -1);
+
+    // Preference of every entry and the transposed entries of every node
+    double *preference = workspace.allocate<double>(entries);
+    bool *rejected = workspace.allocate<bool>(entries, false);
+    size_t *bidderStart = workspace.allocate<size_t>(numVehicles + 1, 0);
+    int *bidderRow = workspace.allocate<int>(entries);
+    size_t *bidderEntry = workspace.allocate<size_t>(entries);
+    for (int r = 0; r < rows; r++) {
+        for (size_t k = feasibility.rowBegin(r); k < feasibility.rowEnd(r); k++) {
+            preference[k] = 1 / feasibility.totalTime(k) - problem.vehicles[feasibility.node(k)].taskPrice;
+            bidderStart[feasibility.node(k) + 1]++;
+        }
+    }
+    for (int j = 0; j < numVehicles; j++) {
+        bidderStart[j + 1] += bidderStart[j];
+    }
+    size_t *bidderFill = workspace.allocate<size_t>(numVehicles);
+    std::copy(bidderStart, bidderStart + numVehicles, bidderFill);
+    for (int r = 0; r < rows; r++) {
+        for (size_t k = feasibility.rowBegin(r); k < feasibility.rowEnd(r); k++) {
+            size_t slot = bidderFill[feasibility.node(k)]++;
+            bidderRow[slot] = r;
+            bidderEntry[slot] = k;
+        }
+    }
+
+    // Per row the entry it proposes to or is held by, rsu or none
+    const long rsu = -2, none = -1;
+    long *target = workspace.allocate<long>(rows, none);
+    bool *rejectedByRsu = workspace.allocate<bool>(rows, false);
+    double *clearingPrice = workspace.allocate<double>(numVehicles, 0.0);
+    bool *touched = workspace.allocate<bool>(numVehicles, false);
+    int *touchedNodes = workspace.allocate<int>(numVehicles);
+    int *freeRows = workspace.allocate<int>(rows);
+    int *nextFree = workspace.allocate<int>(rows);
+    int *candidates = workspace.allocate<int>(rows);
+    size_t *candidateEntries = workspace.allocate<size_t>(rows);
+    int *order = workspace.allocate<int>(rows);
+    int freeCount = rows;
+    for (int r = 0; r < rows; r++) {
+        freeRows[r] = r;
+    }
+
+    auto taskResource = [&](int r) {
+        return problem.vehicles[feasibility.requester(r)].taskResource;
+    };
+
+    int iterations = 0;
+    while (freeCount > 0) {
+        iterations++;
+
+        // Free requesters propose to their best remaining option
+        int touchedCount = 0;
+        bool rsuTouched = false;
+        int nextFreeCount = 0;
+        for (int f = 0; f < freeCount; f++) {
+            int r = freeRows[f];
+            long best = rejectedByRsu[r] ? none : rsu;
+            double bestPreference = 0;
+            for (size_t k = feasibility.rowBegin(r); k < feasibility.rowEnd(r); k++) {
+                if (!rejected[k] && (best == none || preference[k] > bestPreference)) {
+                    best = static_cast<long>(k);
+                    bestPreference = preference[k];
+                }
+            }
+            target[r] = best;
+            if (best == rsu) {
+                rsuTouched = true;
+            } else if (best != none && !touched[feasibility.node(best)]) {
+                touched[feasibility.node(best)] = true;
+                touchedNodes[touchedCount++] = feasibility.node(best);
+            }
+        }
+
+        // Every option keeps its best proposers that fit and rejects the rest
+        for (int t = 0; t < touchedCount; t++) {
+            int j = touchedNodes[t];
+            touched[j] = false;
+            int candidateCount = 0;
+            for (size_t b = bidderStart[j]; b < bidderStart[j + 1]; b++) {
+                if (target[bidderRow[b]] == static_cast<long>(bidderEntry[b])) {
+                    candidates[candidateCount] = bidderRow[b];
+                    candidateEntries[candidateCount++] = bidderEntry[b];
+                }
+            }
+            for (int c = 0; c < candidateCount; c++) {
+                order[c] = c;
+            }
+            std::sort(order, order + candidateCount, [&](int a, int b) {
+                double pa = preference[candidateEntries[a]], pb = preference[candidateEntries[b]];
+                return pa != pb ? pa > pb : candidates[a] < candidates[b];
+            });
+
+            double remaining = problem.vehicles[j].capacity;
+            for (int o = 0; o < candidateCount; o++) {
+                int c = order[o];
+                int r = candidates[c];
+                if (taskResource(r) <= remaining) {
+                    remaining -= taskResource(r);
+                    continue;
+                }
+                size_t k = candidateEntries[c];
+                rejected[k] = true;
+                target[r] = none;
+                clearingPrice[j] = std::max(clearingPrice[j], 1 / feasibility.totalTime(k));
+                nextFree[nextFreeCount++] = r;
+            }
+        }
+        if (rsuTouched) {
+            // The RSU values all tasks alike and prefers lower vehicle indices
+            double remaining = problem.rsuCapacity;
+            for (int r = 0; r < rows; r++) {
+                if (target[r] != rsu) {
+                    continue;
+                }
+                if (taskResource(r) <= remaining) {
+                    remaining -= taskResource(r);
+                    continue;
+                }
+                rejectedByRsu[r] = true;
+                target[r] = none;
+                nextFree[nextFreeCount++] = r;
+            }
+        }
+
+        // Requesters rejected by every option drop out
+        freeCount = 0;
+        for (int f = 0; f < nextFreeCount; f++) {
+            int r = nextFree[f];
+            bool exhausted = rejectedByRsu[r];
+            for (size_t k = feasibility.rowBegin(r); exhausted && k < feasibility.rowEnd(r); k++) {
+                exhausted = rejected[k];
+            }
+            if (!exhausted) {
+                freeRows[freeCount++] = r;
+            }
+        }
+    }
+
+    for (int r = 0; r < rows; r++) {
+        int i = feasibility.requester(r);
+        if (target[r] == rsu) {
+            assignment[i] = i;
+        } else if (target[r] != none) {
+            assignment[i] = feasibility.node(target[r]);
+        }
+    }
+    for (int j = 0; j < numVehicles; j++) {
+        if (bidderStart[j + 1] > bidderStart[j]) {
+            problem.vehicles[j].taskPrice = clearingPrice[j];
+        }
+    }
+
+    result.success = true;
+    result.iterations = iterations;
+    return result;
+}
@@ -0,0 +1,22 @@
+#pragma once
+
+#include "Matcher.h"
+
+// Many-to-one deferred acceptance with task sizes.
+//
+// Fog node j can serve tasks with a total taskResource up to its capacity,
+// the RSU up to the problem's rsuCapacity. Every free requester proposes to
+// its best option it was not rejected by, ranking fog nodes by
+// 1 / totalTime - taskPrice and the RSU at 0. Each option then keeps its
+// best proposers, by that value and then by vehicle index, as long as their
+// tasks fit, and rejects the others for good. Requesters that every option
+// rejected stay unassigned (-1) for a later round.
+//
+// A node's taskPrice becomes the highest value among the requesters it
+// rejected, 0 if it rejected none, which steers the next round away from
+// contested nodes. Since the RSU capacity is shared by all requesters,
+// solves are never split into components.
+class CapacityMatcher : public Matcher {
+protected:
+    MatchResult solve(MatchingProblem &problem, const FeasibilityMatrix &feasibility) override;
+};
@@ -0,0 +1,170 @@
+#include "FeasibilityMatrix.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// Squared distance (into distanceSquared) and contact duration of one source
+// vehicle to all columns. Branch free and restrict qualified so it vectorizes.
+void contactKernel(size_t cols, const double *__restrict x, const double *__restrict y, const double *__restrict z,
+                   const double *__restrict speedX, const double *__restrict speedY, const double *__restrict speedZ,
+                   const MatchingVehicle &source, double rangeSquared,
+                   double *__restrict distanceSquared, double *__restrict contact) {
+    const double sourceX = source.x, sourceY = source.y, sourceZ = source.z;
+    const double sourceSpeedX = source.speedX, sourceSpeedY = source.speedY, sourceSpeedZ = source.speedZ;
+
+    for (size_t c = 0; c < cols; c++) {
+        double distanceX = x[c] - sourceX;
+        double distanceY = y[c] - sourceY;
+        double distanceZ = z[c] - sourceZ;
+        double relativeSpeedX = speedX[c] - sourceSpeedX;
+        double relativeSpeedY = speedY[c] - sourceSpeedY;
+        double relativeSpeedZ = speedZ[c] - sourceSpeedZ;
+
+        double d2 = distanceX * distanceX + distanceY * distanceY + distanceZ * distanceZ;
+        double a = relativeSpeedX * relativeSpeedX + relativeSpeedY * relativeSpeedY + relativeSpeedZ * relativeSpeedZ;
+        double b = 2 * (distanceX * relativeSpeedX + distanceY * relativeSpeedY + distanceZ * relativeSpeedZ);
+        double discriminant = b * b - 4 * a * (d2 - rangeSquared);
+        double exit = (-b + std::sqrt(discriminant > 0 ? discriminant : 0.0)) / (2 * a);
+
+        bool stationary = (a == 0) | (discriminant < 0);
+        double duration = stationary ? 1000000.0 : exit;
+        contact[c] = d2 < rangeSquared ? duration : 0.0;
+        distanceSquared[c] = d2;
+    }
+}
+
+// Caps the constant velocity contact durations at the point where the source
+// or the candidate turns off its heading. From there on nothing is known about
+// the direction of either, so only the time both need to close the remaining
+// gap to the range border at their combined speed is credited.
+void boundContactByRoute(size_t cols, const int *candidates, const std::vector<MatchingVehicle> &vehicles,
+                         const MatchingVehicle &source, double rangeRadius, double *contact) {
+    const double sourceSpeed = std::sqrt(source.speedX * source.speedX + source.speedY * source.speedY +
+                                         source.speedZ * source.speedZ);
+
+    for (size_t c = 0; c < cols; c++) {
+        const MatchingVehicle &d = vehicles[candidates[c]];
+        double horizon = std::min(source.straightHorizon, d.straightHorizon);
+        if (contact[c] <= horizon) {
+            continue;
+        }
+        double relativeSpeedX = d.speedX - source.speedX;
+        double relativeSpeedY = d.speedY - source.speedY;
+        double relativeSpeedZ = d.speedZ - source.speedZ;
+        double distanceX = d.x - source.x + relativeSpeedX * horizon;
+        double distanceY = d.y - source.y + relativeSpeedY * horizon;
+        double distanceZ = d.z - source.z + relativeSpeedZ * horizon;
+        double gap = rangeRadius - std::sqrt(distanceX * distanceX + distanceY * distanceY + distanceZ * distanceZ);
+        double closingSpeed = sourceSpeed + std::sqrt(d.speedX * d.speedX + d.speedY * d.speedY + d.speedZ * d.speedZ);
+        if (closingSpeed > 0) {
+            contact[c] = std::min(contact[c], horizon + std::max(0.0, gap) / closingSpeed);
+        }
+    }
+}
+
+} // namespace
+
+void FeasibilityMatrix::build(const MatchingProblem &problem) {
+    const double rangeSquared = problem.rangeRadius * problem.rangeRadius;
+
+    const SpatialGrid *index = problem.fogNodeIndex;
+    if (!index) {
+        ownIndex.setCellSize(problem.rangeRadius);
+        ownIndex.clear();
+        for (int i = 0; i < problem.size(); i++) {
+            if (problem.vehicles[i].sharedResource != 0) {
+                ownIndex.update(i, problem.vehicles[i].x, problem.vehicles[i].y);
+            }
+        }
+        index = &ownIndex;
+    }
+
+    requesters.clear();
+    rowStart.clear();
+    nodes.clear();
+    totalTimes.clear();
+    contactDurations.clear();
+    rowStart.push_back(0);
+
+    for (int i = 0; i < problem.size(); i++) {
+        const MatchingVehicle &s = problem.vehicles[i];
+        if (!s.isTaskReady) {
+            continue;
+        }
+        requesters.push_back(i);
+
+        // Gather the fog nodes around the requester
+        candidates.clear();
+        index->query(s.x, s.y, problem.rangeRadius, candidates);
+        std::sort(candidates.begin(), candidates.end());
+        size_t count = 0;
+        for (int j : candidates) {
+            if (j == i || j >= problem.size() || problem.vehicles[j].sharedResource == 0) {
+                continue;
+            }
+            candidates[count++] = j;
+        }
+        candidates.resize(count);
+
+        x.resize(count);
+        y.resize(count);
+        z.resize(count);
+        speedX.resize(count);
+        speedY.resize(count);
+        speedZ.resize(count);
+        distanceSquared.resize(count);
+        contact.resize(count);
+        for (size_t c = 0; c < count; c++) {
+            const MatchingVehicle &d = problem.vehicles[candidates[c]];
+            x[c] = d.x;
+            y[c] = d.y;
+            z[c] = d.z;
+            speedX[c] = d.speedX;
+            speedY[c] = d.speedY;
+            speedZ[c] = d.speedZ;
+        }
+
+        contactKernel(count, x.data(), y.data(), z.data(), speedX.data(), speedY.data(), speedZ.data(), s, rangeSquared, distanceSquared.data(), contact.data());
+        if (problem.contactModel == ContactModel::ROUTE) {
+            boundContactByRoute(count, candidates.data(), problem.vehicles, s, problem.rangeRadius, contact.data());
+        }
+
+        // Transmission time and constraints, only for pairs within range
+        for (size_t c = 0; c < count; c++) {
+            if (contact[c] == 0) {
+                continue;
+            }
+            const MatchingVehicle &d = problem.vehicles[candidates[c]];
+            double transmissionTime = s.taskDataSize / (3000000 * std::log(1 + 0.1 / distanceSquared[c]));
+            double time = s.taskResource / d.sharedResource + transmissionTime;
+            if (transmissionTime > contact[c] || time / 10 > s.delayConstraint) {
+                continue;
+            }
+            nodes.push_back(candidates[c]);
+            totalTimes.push_back(time);
+            contactDurations.push_back(contact[c]);
+        }
+        rowStart.push_back(nodes.size());
+    }
+}
+
+void FeasibilityMatrix::extract(const FeasibilityMatrix &source, const std::vector<int> &sourceRows, const std::vector<int> &localIndex) {
+    requesters.clear();
+    rowStart.clear();
+    nodes.clear();
+    totalTimes.clear();
+    contactDurations.clear();
+    rowStart.push_back(0);
+
+    for (int r : sourceRows) {
+        requesters.push_back(localIndex[source.requester(r)]);
+        for (size_t k = source.rowBegin(r); k < source.rowEnd(r); k++) {
+            nodes.push_back(localIndex[source.node(k)]);
+            totalTimes.push_back(source.totalTime(k));
+            contactDurations.push_back(source.contactDuration(k));
+        }
+        rowStart.push_back(nodes.size());
+    }
+}
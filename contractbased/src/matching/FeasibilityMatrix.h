@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "MatchingProblem.h"
+#include "SpatialGrid.h"
+
+// Offloading cost of every feasible (requester, fog node) pair of a matching
+// problem, computed once when matching starts.
+//
+// Rows are the vehicles with a ready task in vehicle index order. Only fog
+// nodes within rangeRadius are considered, found through the problem's
+// fogNodeIndex or, without one, a grid built from the snapshot. Candidates
+// are gathered into a structure of arrays so the per-row kernel runs over
+// contiguous columns without branches and can be vectorized by the compiler.
+// Each row stores its feasible entries in fog node index order.
+class FeasibilityMatrix {
+private:
+    SpatialGrid ownIndex;
+
+    // Structure-of-arrays snapshot of the candidates of one row
+    std::vector<int> candidates;
+    std::vector<double> x, y, z;
+    std::vector<double> speedX, speedY, speedZ;
+    std::vector<double> distanceSquared;
+    std::vector<double> contact;
+
+    std::vector<int> requesters;
+    std::vector<size_t> rowStart;
+    std::vector<int> nodes;
+    std::vector<double> totalTimes;
+    std::vector<double> contactDurations;
+
+public:
+    void build(const MatchingProblem &problem);
+
+    // Copies the given rows of source, renumbering vehicles through
+    // localIndex. Keeps the entry order if localIndex is increasing.
+    void extract(const FeasibilityMatrix &source, const std::vector<int> &sourceRows, const std::vector<int> &localIndex);
+
+    int rows() const {
+        return static_cast<int>(requesters.size());
+    }
+
+    // Vehicle index of requester row r
+    int requester(int r) const {
+        return requesters[r];
+    }
+
+    // Entries of row r are [rowBegin(r), rowEnd(r))
+    size_t rowBegin(int r) const {
+        return rowStart[r];
+    }
+
+    size_t rowEnd(int r) const {
+        return rowStart[r + 1];
+    }
+
+    size_t entries() const {
+        return nodes.size();
+    }
+
+    // Vehicle index of the fog node of entry k
+    int node(size_t k) const {
+        return nodes[k];
+    }
+
+    // Computation plus transmission time of entry k
+    double totalTime(size_t k) const {
+        return totalTimes[k];
+    }
+
+    // Time until the pair of entry k leaves each other's range at their current speeds.
+    double contactDuration(size_t k) const {
+        return contactDurations[k];
+    }
+};
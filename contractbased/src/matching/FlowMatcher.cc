@@ -0,0 +1,153 @@
+#include "FlowMatcher.h"
+
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <utility>
+
+Matcher *FlowMatcher::clone() const {
+    return new FlowMatcher();
+}
+
+MatchResult FlowMatcher::solve(MatchingProblem &problem, const FeasibilityMatrix &feasibility) {
+    int numVehicles = problem.size();
+    int rows = feasibility.rows();
+    size_t entries = feasibility.entries();
+
+    MatchResult result;
+    std::vector<int> &assignment = result.assignment;
+    assignment.assign(numVehicles, -1);
+
+    // Vertices: requester rows, then fog nodes in compact numbering, then the sink
+    int *nodeOf = workspace.allocate<int>(numVehicles, -1);
+    int *vehicleOf = workspace.allocate<int>(numVehicles);
+    int nodes = 0;
+    double maxValue = 0;
+    for (size_t k = 0; k < entries; k++) {
+        if (nodeOf[feasibility.node(k)] == -1) {
+            vehicleOf[nodes] = feasibility.node(k);
+            nodeOf[feasibility.node(k)] = nodes++;
+        }
+        maxValue = std::max(maxValue, 1 / feasibility.totalTime(k));
+    }
+    int vertices = rows + nodes + 1;
+    int sink = vertices - 1;
+
+    // Costs are -1 / totalTime on requester to node edges and 0 into the
+    // sink; starting potentials make every reduced cost non-negative
+    double *potential = workspace.allocate<double>(vertices, -maxValue);
+    int *owner = workspace.allocate<int>(nodes, -1); // row holding each node
+    long *held = workspace.allocate<long>(rows, -1); // entry held by each row, -1 at the RSU or unassigned
+
+    double *distance = workspace.allocate<double>(vertices, std::numeric_limits<double>::infinity());
+    long *via = workspace.allocate<long>(vertices); // entry of the edge into a node, or node into a row, on the path
+    int *from = workspace.allocate<int>(vertices);
+    bool *done = workspace.allocate<bool>(vertices, false);
+    int *visited = workspace.allocate<int>(vertices);
+    typedef std::pair<double, int> QueueItem;
+    QueueItem *queue = workspace.allocate<QueueItem>(entries + 2 * static_cast<size_t>(vertices));
+
+    auto cost = [&](size_t k) {
+        return -1 / feasibility.totalTime(k);
+    };
+
+    int iterations = 0;
+    for (int s = 0; s < rows; s++) {
+        // A new requester has no incoming residual edges, so its potential
+        // can be raised until its own edges have non-negative reduced costs
+        potential[s] = potential[sink];
+        for (size_t k = feasibility.rowBegin(s); k < feasibility.rowEnd(s); k++) {
+            potential[s] = std::max(potential[s], potential[rows + nodeOf[feasibility.node(k)]] - cost(k));
+        }
+
+        int visitedCount = 0;
+        size_t queueSize = 0;
+        auto relax = [&](int v, double d, int u, long edge) {
+            if (d < distance[v]) {
+                if (distance[v] == std::numeric_limits<double>::infinity()) {
+                    visited[visitedCount++] = v;
+                }
+                distance[v] = d;
+                from[v] = u;
+                via[v] = edge;
+                queue[queueSize++] = QueueItem(d, v);
+                std::push_heap(queue, queue + queueSize, std::greater<QueueItem>());
+            }
+        };
+
+        relax(s, 0, -1, -1);
+        while (queueSize > 0) {
+            iterations++;
+            std::pop_heap(queue, queue + queueSize, std::greater<QueueItem>());
+            QueueItem item = queue[--queueSize];
+            int u = item.second;
+            if (done[u] || item.first > distance[u]) {
+                continue;
+            }
+            done[u] = true;
+            if (u == sink) {
+                break;
+            }
+
+            if (u < rows) {
+                // A requester can move to any other feasible node or to the RSU
+                for (size_t k = feasibility.rowBegin(u); k < feasibility.rowEnd(u); k++) {
+                    if (static_cast<long>(k) == held[u]) {
+                        continue;
+                    }
+                    int v = rows + nodeOf[feasibility.node(k)];
+                    relax(v, distance[u] + cost(k) + potential[u] - potential[v], u, static_cast<long>(k));
+                }
+                relax(sink, distance[u] + potential[u] - potential[sink], u, -1);
+            } else {
+                // A free node goes to the sink, a held one back to its holder
+                int r = owner[u - rows];
+                if (r == -1) {
+                    relax(sink, distance[u] + potential[u] - potential[sink], u, -1);
+                } else {
+                    relax(r, distance[u] - cost(held[r]) + potential[u] - potential[r], u, held[r]);
+                }
+            }
+        }
+
+        // Augment along the path: every node goes to the requester before it,
+        // and a requester right before the sink moves to the RSU
+        int v = from[sink];
+        if (v < rows) {
+            held[v] = -1;
+        }
+        while (v != s) {
+            if (v >= rows) {
+                int r = from[v];
+                owner[v - rows] = r;
+                held[r] = via[v];
+            }
+            v = from[v];
+        }
+
+        // Keep reduced costs non-negative; shifting by the sink distance
+        // leaves the vertices the search did not settle unchanged
+        double sinkDistance = distance[sink];
+        for (int i = 0; i < visitedCount; i++) {
+            int w = visited[i];
+            if (done[w]) {
+                potential[w] += distance[w] - sinkDistance;
+            }
+            distance[w] = std::numeric_limits<double>::infinity();
+            done[w] = false;
+        }
+    }
+
+    for (int r = 0; r < rows; r++) {
+        int i = feasibility.requester(r);
+        assignment[i] = held[r] == -1 ? i : feasibility.node(held[r]);
+    }
+    // Dual price of each node: what its holder gives up against the RSU
+    for (int n = 0; n < nodes; n++) {
+        problem.vehicles[vehicleOf[n]].taskPrice = std::max(0.0, potential[sink] - potential[rows + n]);
+    }
+
+    result.success = true;
+    result.iterations = iterations;
+    return result;
+}
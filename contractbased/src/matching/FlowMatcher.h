@@ -0,0 +1,18 @@
+#pragma once
+
+#include "Matcher.h"
+
+// Exact assignment by min-cost flow, as a reference for the price based
+// engines.
+//
+// Maximizes the sum of 1 / totalTime over the tasks placed on fog nodes,
+// each node taking at most one task and the RSU any number at value 0.
+// Requesters are added one at a time, each along a shortest augmenting path
+// found by Dijkstra on reduced costs (successive shortest paths with
+// potentials), so a search only visits the requesters and nodes it can
+// displace. The taskPrice of every node becomes its optimal dual price.
+class FlowMatcher : public Matcher {
+protected:
+    MatchResult solve(MatchingProblem &problem, const FeasibilityMatrix &feasibility) override;
+    Matcher *clone() const override;
+};
@@ -0,0 +1,245 @@
+#include "Matcher.h"
+
+#include <algorithm>
+#include <chrono>
+#include <limits>
+#include <numeric>
+
+#include "AuctionMatcher.h"
+#include "CapacityMatcher.h"
+#include "FlowMatcher.h"
+#include "ProposalMatcher.h"
+
+void Matcher::setThreads(int count) {
+    threads = count;
+    pool.reset();
+    workers.clear();
+}
+
+MatchResult Matcher::run(MatchingProblem &problem) {
+    auto start = std::chrono::steady_clock::now();
+    if (!warmStart) {
+        for (MatchingVehicle &vehicle : problem.vehicles) {
+            vehicle.taskPrice = 0;
+        }
+    }
+    feasibilityMatrix.build(problem);
+    previousAssignment.resize(problem.size(), -1);
+    previousTotalTime.resize(problem.size(), 0);
+
+    MatchResult result;
+    int components = threads != 1 ? findComponents(problem) : 0;
+    if (components > 1) {
+        result = solveComponents(problem, components);
+    } else {
+        workspace.reset();
+        result = solve(problem, feasibilityMatrix);
+    }
+
+    if (result.success) {
+        previousAssignment = result.assignment;
+        std::fill(previousTotalTime.begin(), previousTotalTime.end(), 0);
+        result.backup.assign(problem.size(), -1);
+        for (int r = 0; r < feasibilityMatrix.rows(); r++) {
+            int i = feasibilityMatrix.requester(r);
+            for (size_t k = feasibilityMatrix.rowBegin(r); k < feasibilityMatrix.rowEnd(r); k++) {
+                if (feasibilityMatrix.node(k) == result.assignment[i]) {
+                    previousTotalTime[i] = feasibilityMatrix.totalTime(k);
+                    result.objective += 1 / feasibilityMatrix.totalTime(k);
+                    if (feasibilityMatrix.contactDuration(k) < hedgeMargin * feasibilityMatrix.totalTime(k)) {
+                        result.backup[i] = chooseBackup(r, result.assignment[i]);
+                    }
+                    break;
+                }
+            }
+        }
+    }
+    result.wallTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return result;
+}
+
+int Matcher::chooseBackup(int row, int primary) const {
+    int backup = feasibilityMatrix.requester(row);
+    double backupTime = std::numeric_limits<double>::infinity();
+    for (size_t k = feasibilityMatrix.rowBegin(row); k < feasibilityMatrix.rowEnd(row); k++) {
+        double time = feasibilityMatrix.totalTime(k);
+        if (feasibilityMatrix.node(k) != primary && time < backupTime &&
+            feasibilityMatrix.contactDuration(k) >= hedgeMargin * time) {
+            backup = feasibilityMatrix.node(k);
+            backupTime = time;
+        }
+    }
+    return backup;
+}
+
+// Groups the requesters and their feasible fog nodes into connected
+// components and returns their number, 0 if this matcher cannot be split.
+int Matcher::findComponents(const MatchingProblem &problem) {
+    if (workers.empty()) {
+        std::unique_ptr<Matcher> probe(clone());
+        if (!probe) {
+            return 0;
+        }
+        pool.reset(new ThreadPool(threads));
+        for (int w = 0; w < pool->size(); w++) {
+            workers.emplace_back(new Worker());
+            workers.back()->matcher.reset(w == 0 ? probe.release() : clone());
+        }
+    }
+
+    // Union-find over vehicle indices, linking each requester to its fog nodes.
+    // Links always point to a smaller index, so a root is the smallest vehicle of its component.
+    int numVehicles = problem.size();
+    parent.resize(numVehicles);
+    std::iota(parent.begin(), parent.end(), 0);
+    auto find = [&](int i) {
+        while (parent[i] != i) {
+            parent[i] = parent[parent[i]];
+            i = parent[i];
+        }
+        return i;
+    };
+    for (int r = 0; r < feasibilityMatrix.rows(); r++) {
+        int i = find(feasibilityMatrix.requester(r));
+        for (size_t k = feasibilityMatrix.rowBegin(r); k < feasibilityMatrix.rowEnd(r); k++) {
+            int j = find(feasibilityMatrix.node(k));
+            if (i != j) {
+                // The smaller root wins, so the grouping does not depend on the entry order
+                parent[std::max(i, j)] = std::min(i, j);
+                i = std::min(i, j);
+            }
+        }
+    }
+
+    // Number the components by their smallest vehicle; vehicles without a
+    // ready task or feasible pair belong to none
+    componentOf.resize(numVehicles);
+    std::vector<int> &label = localIndex;
+    label.assign(numVehicles, -1);
+    componentStart.assign(1, 0);
+    for (int r = 0; r < feasibilityMatrix.rows(); r++) {
+        label[feasibilityMatrix.requester(r)] = -2;
+        for (size_t k = feasibilityMatrix.rowBegin(r); k < feasibilityMatrix.rowEnd(r); k++) {
+            label[feasibilityMatrix.node(k)] = -2;
+        }
+    }
+    int components = 0;
+    for (int i = 0; i < numVehicles; i++) {
+        if (label[i] == -1) {
+            componentOf[i] = -1;
+            continue;
+        }
+        int root = find(i);
+        if (root == i) {
+            label[i] = components++;
+            componentStart.push_back(0);
+        }
+        componentOf[i] = label[root];
+        componentStart[componentOf[i] + 1]++;
+    }
+    std::partial_sum(componentStart.begin(), componentStart.end(), componentStart.begin());
+    members.resize(componentStart.back());
+    fill.assign(componentStart.begin(), componentStart.end() - 1);
+    for (int i = 0; i < numVehicles; i++) {
+        if (componentOf[i] != -1) {
+            members[fill[componentOf[i]]++] = i;
+        }
+    }
+    return components;
+}
+
+MatchResult Matcher::solveComponents(MatchingProblem &problem, int components) {
+    // Local index of every vehicle within its component
+    for (int c = 0; c < components; c++) {
+        for (int m = componentStart[c]; m < componentStart[c + 1]; m++) {
+            localIndex[members[m]] = m - componentStart[c];
+        }
+    }
+
+    // Rows by component, in row order
+    componentRowStart.assign(components + 1, 0);
+    for (int r = 0; r < feasibilityMatrix.rows(); r++) {
+        componentRowStart[componentOf[feasibilityMatrix.requester(r)] + 1]++;
+    }
+    std::partial_sum(componentRowStart.begin(), componentRowStart.end(), componentRowStart.begin());
+    componentRows.resize(feasibilityMatrix.rows());
+    fill.assign(componentRowStart.begin(), componentRowStart.end() - 1);
+    for (int r = 0; r < feasibilityMatrix.rows(); r++) {
+        componentRows[fill[componentOf[feasibilityMatrix.requester(r)]]++] = r;
+    }
+
+    // Largest components first so the last ones to finish are small
+    std::vector<int> &order = componentOrder;
+    order.resize(components);
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&](int a, int b) {
+        return componentStart[a + 1] - componentStart[a] > componentStart[b + 1] - componentStart[b];
+    });
+
+    componentResults.resize(components);
+    pool->parallelFor(components, [&](int w, int index) {
+        int c = order[index];
+        Worker &worker = *workers[w];
+        Matcher &matcher = *worker.matcher;
+        int offset = componentStart[c];
+        int size = componentStart[c + 1] - offset;
+
+        // The component as a problem of its own, with the warm start state renumbered
+        worker.problem.copySettings(problem);
+        worker.problem.vehicles.resize(size);
+        matcher.warmStart = warmStart;
+        matcher.previousAssignment.resize(size);
+        matcher.previousTotalTime.resize(size);
+        for (int l = 0; l < size; l++) {
+            int i = members[offset + l];
+            int previous = previousAssignment[i];
+            worker.problem.vehicles[l] = problem.vehicles[i];
+            matcher.previousAssignment[l] = previous >= 0 && componentOf[previous] == c ? localIndex[previous] : -1;
+            matcher.previousTotalTime[l] = previousTotalTime[i];
+        }
+        worker.rows.assign(componentRows.begin() + componentRowStart[c], componentRows.begin() + componentRowStart[c + 1]);
+        worker.feasibility.extract(feasibilityMatrix, worker.rows, localIndex);
+
+        matcher.workspace.reset();
+        componentResults[c] = matcher.solve(worker.problem, worker.feasibility);
+
+        // Components are disjoint, so workers write to different vehicles
+        if (componentResults[c].success) {
+            for (int l = 0; l < size; l++) {
+                int i = members[offset + l];
+                problem.vehicles[i].taskPrice = worker.problem.vehicles[l].taskPrice;
+            }
+        }
+    });
+
+    // Merge in component order
+    MatchResult result;
+    result.assignment.assign(problem.size(), -1);
+    result.success = true;
+    for (int c = 0; c < components; c++) {
+        const MatchResult &part = componentResults[c];
+        result.success = result.success && part.success;
+        result.iterations += part.iterations;
+        if (!part.success) {
+            continue;
+        }
+        for (int l = 0; l < componentStart[c + 1] - componentStart[c]; l++) {
+            int local = part.assignment[l];
+            result.assignment[members[componentStart[c] + l]] = local == -1 ? -1 : members[componentStart[c] + local];
+        }
+    }
+    return result;
+}
+
+Matcher *createMatcher(const std::string &engine) {
+    if (engine == "proposal") {
+        return new ProposalMatcher();
+    } else if (engine == "auction") {
+        return new AuctionMatcher();
+    } else if (engine == "capacity") {
+        return new CapacityMatcher();
+    } else if (engine == "flow") {
+        return new FlowMatcher();
+    }
+    return nullptr;
+}
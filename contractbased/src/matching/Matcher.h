@@ -0,0 +1,113 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "FeasibilityMatrix.h"
+#include "MatchingProblem.h"
+#include "MatchingWorkspace.h"
+#include "ThreadPool.h"
+
+struct MatchResult {
+    // Per vehicle: -1 if it has no task, its own index if the RSU serves
+    // the task, otherwise the index of the fog node.
+    std::vector<int> assignment;
+    // Per vehicle: -1 unless the task is hedged, otherwise where to start a
+    // second copy if the first is late, encoded like assignment. Backups are
+    // speculative and not counted against any capacity.
+    std::vector<int> backup;
+    bool success = false;
+    int iterations = 0;
+    double objective = 0; // sum of 1 / totalTime over the tasks placed on fog nodes
+    double wallTime = 0; // seconds
+};
+
+class Matcher {
+public:
+    virtual ~Matcher() = default;
+
+    // Assigns every ready task of the problem and times the solve.
+    // Matchers may update the taskPrice of fog nodes in the problem.
+    MatchResult run(MatchingProblem &problem);
+
+    // With warm start (the default) a solve starts from the prices in the
+    // problem, normally those of the previous round, and matchers may reuse
+    // what is still valid of their previous result. Without it every solve
+    // starts from zero prices.
+    void setWarmStart(bool enabled) {
+        warmStart = enabled;
+    }
+
+    // Solves the connected components of the feasibility graph, which share
+    // no requester or fog node, on up to threads threads; 0 uses one per
+    // hardware thread. Each component is solved as its own problem and the
+    // results are merged by vehicle index, so assignments are the same for
+    // every thread count other than 1. A single thread solves the problem in
+    // one piece, which reaches the same objective (within the auction's
+    // epsilon) but may break ties differently. Has no effect on matchers that
+    // do not clone().
+    void setThreads(int threads);
+
+    // Hedges a fog assignment whose contact duration is less than margin
+    // times its total time: the fog node may leave range before the result
+    // is back. Its backup is the feasible fog node with the shortest total
+    // time among those that are not tight themselves, or the RSU. 0 (the
+    // default) disables hedging.
+    void setHedgeMargin(double margin) {
+        hedgeMargin = margin;
+    }
+
+private:
+    FeasibilityMatrix feasibilityMatrix;
+
+    // Parallel solving over components, see setThreads()
+    struct Worker {
+        std::unique_ptr<Matcher> matcher;
+        MatchingProblem problem;
+        FeasibilityMatrix feasibility;
+        std::vector<int> rows;
+    };
+    double hedgeMargin = 0;
+    int threads = 1;
+    std::unique_ptr<ThreadPool> pool;
+    std::vector<std::unique_ptr<Worker>> workers;
+    std::vector<int> parent;
+    std::vector<int> componentOf; // per vehicle, -1 if in no component
+    std::vector<int> componentStart;
+    std::vector<int> members; // vehicle indices by component, increasing within each
+    std::vector<int> componentRowStart;
+    std::vector<int> componentRows; // feasibility rows by component
+    std::vector<int> componentOrder;
+    std::vector<int> localIndex;
+    std::vector<int> fill;
+    std::vector<MatchResult> componentResults;
+
+    int findComponents(const MatchingProblem &problem);
+    MatchResult solveComponents(MatchingProblem &problem, int components);
+    int chooseBackup(int row, int primary) const;
+
+protected:
+    bool warmStart = true;
+
+    // Per vehicle result of the last successful solve: the assignment and
+    // the total time of the assigned fog node, for warm starts
+    std::vector<int> previousAssignment;
+    std::vector<double> previousTotalTime;
+
+    // Scratch buffers, reset before every solve
+    MatchingWorkspace workspace;
+
+    // Must only read pair costs from feasibility, which run() has built for problem.
+    virtual MatchResult solve(MatchingProblem &problem, const FeasibilityMatrix &feasibility) = 0;
+
+    // Returns a new matcher with the same settings for solving components
+    // concurrently, or nullptr if the solves must not be split.
+    virtual Matcher *clone() const {
+        return nullptr;
+    }
+};
+
+// Returns a new matcher for engine "proposal", "auction", "capacity" or "flow",
+// or nullptr if the name is unknown.
+Matcher *createMatcher(const std::string &engine);
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <limits>
+#include <vector>
+
+class SpatialGrid;
+
+// Snapshot of the per-vehicle state the task assignment reads.
+struct MatchingVehicle {
+    double x = 0, y = 0, z = 0; // position
+    double speedX = 0, speedY = 0, speedZ = 0;
+    double taskResource = 0; // (C)
+    double taskDataSize = 0; // (D)
+    double delayConstraint = 0; // (tao)
+    double sharedResource = 0; // resource of the chosen contract, 0 if the vehicle is no fog node
+    double taskPrice = 0; // matching price of the vehicle as a fog node
+    double capacity = 0; // total taskResource the vehicle can take on as a fog node in one round, for capacity aware matchers
+    double straightHorizon = std::numeric_limits<double>::infinity(); // s the vehicle keeps its heading along its route, for the route contact model
+    bool isTaskReady = false;
+};
+
+// How FeasibilityMatrix predicts the contact duration of a pair.
+enum class ContactModel {
+    CONSTANT_VELOCITY, // both vehicles keep their speed and heading
+    ROUTE // as above until the first of them turns off its heading, then only the remaining range gap is credited
+};
+
+// Input of one task assignment round; the cost model lives in FeasibilityMatrix.
+struct MatchingProblem {
+    std::vector<MatchingVehicle> vehicles;
+    double rangeRadius = 400;
+    double rsuCapacity = std::numeric_limits<double>::infinity(); // total taskResource the RSU takes in one round, for capacity aware matchers
+    ContactModel contactModel = ContactModel::CONSTANT_VELOCITY;
+
+    // Optional index of the fog nodes by vehicle index at the positions in
+    // vehicles, kept up to date by the caller; without it the feasibility
+    // matrix indexes the snapshot itself.
+    const SpatialGrid *fogNodeIndex = nullptr;
+
+    int size() const {
+        return static_cast<int>(vehicles.size());
+    }
+
+    // Copies everything of other but its vehicles and fog node index, for a
+    // problem made of some of other's vehicles
+    void copySettings(const MatchingProblem &other) {
+        rangeRadius = other.rangeRadius;
+        rsuCapacity = other.rsuCapacity;
+        contactModel = other.contactModel;
+        fogNodeIndex = nullptr;
+    }
+};
@@ -0,0 +1,132 @@
+#include "MatchingSnapshot.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+
+namespace {
+
+const char magic[4] = {'C', 'B', 'M', 'S'};
+const uint32_t version = 2;
+
+struct Record {
+    uint32_t index;
+    uint32_t isTaskReady;
+    double x, y, z;
+    double speedX, speedY, speedZ;
+    double taskResource;
+    double taskDataSize;
+    double delayConstraint;
+    double sharedResource;
+    double taskPrice;
+    double capacity;
+    double straightHorizon;
+};
+
+struct Header {
+    char magic[4];
+    uint32_t version;
+    uint32_t vehicles;
+    uint32_t records;
+    double rangeRadius;
+    double rsuCapacity;
+    uint32_t contactModel;
+};
+
+struct FileCloser {
+    void operator()(FILE *file) const {
+        std::fclose(file);
+    }
+};
+
+} // namespace
+
+bool MatchingSnapshot::write(const std::string &path, const MatchingProblem &problem) {
+    std::unique_ptr<FILE, FileCloser> file(std::fopen(path.c_str(), "wb"));
+    if (!file) {
+        return false;
+    }
+
+    // Structs are written as they are, so their padding is zeroed to keep
+    // snapshots of the same problem byte for byte equal
+    Header header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, magic, sizeof(magic));
+    header.version = version;
+    header.vehicles = static_cast<uint32_t>(problem.size());
+    header.rangeRadius = problem.rangeRadius;
+    header.rsuCapacity = problem.rsuCapacity;
+    header.contactModel = static_cast<uint32_t>(problem.contactModel);
+    for (const MatchingVehicle &v : problem.vehicles) {
+        header.records += v.isTaskReady || v.sharedResource != 0;
+    }
+    bool ok = std::fwrite(&header, sizeof(header), 1, file.get()) == 1;
+
+    for (int i = 0; ok && i < problem.size(); i++) {
+        const MatchingVehicle &v = problem.vehicles[i];
+        if (!v.isTaskReady && v.sharedResource == 0) {
+            continue;
+        }
+        Record record;
+        std::memset(&record, 0, sizeof(record));
+        record.index = static_cast<uint32_t>(i);
+        record.isTaskReady = v.isTaskReady;
+        record.x = v.x;
+        record.y = v.y;
+        record.z = v.z;
+        record.speedX = v.speedX;
+        record.speedY = v.speedY;
+        record.speedZ = v.speedZ;
+        record.taskResource = v.taskResource;
+        record.taskDataSize = v.taskDataSize;
+        record.delayConstraint = v.delayConstraint;
+        record.sharedResource = v.sharedResource;
+        record.taskPrice = v.taskPrice;
+        record.capacity = v.capacity;
+        record.straightHorizon = v.straightHorizon;
+        ok = std::fwrite(&record, sizeof(record), 1, file.get()) == 1;
+    }
+    return std::fclose(file.release()) == 0 && ok;
+}
+
+bool MatchingSnapshot::read(const std::string &path, MatchingProblem &problem) {
+    std::unique_ptr<FILE, FileCloser> file(std::fopen(path.c_str(), "rb"));
+    if (!file) {
+        return false;
+    }
+
+    Header header;
+    if (std::fread(&header, sizeof(header), 1, file.get()) != 1 || std::string(header.magic, 4) != std::string(magic, 4) ||
+        header.version != version) {
+        return false;
+    }
+    problem.rangeRadius = header.rangeRadius;
+    problem.rsuCapacity = header.rsuCapacity;
+    problem.contactModel = static_cast<ContactModel>(header.contactModel);
+    problem.fogNodeIndex = nullptr;
+    problem.vehicles.assign(header.vehicles, MatchingVehicle());
+
+    for (uint32_t r = 0; r < header.records; r++) {
+        Record record;
+        if (std::fread(&record, sizeof(record), 1, file.get()) != 1 || record.index >= header.vehicles) {
+            return false;
+        }
+        MatchingVehicle &v = problem.vehicles[record.index];
+        v.x = record.x;
+        v.y = record.y;
+        v.z = record.z;
+        v.speedX = record.speedX;
+        v.speedY = record.speedY;
+        v.speedZ = record.speedZ;
+        v.taskResource = record.taskResource;
+        v.taskDataSize = record.taskDataSize;
+        v.delayConstraint = record.delayConstraint;
+        v.sharedResource = record.sharedResource;
+        v.taskPrice = record.taskPrice;
+        v.capacity = record.capacity;
+        v.straightHorizon = record.straightHorizon;
+        v.isTaskReady = record.isTaskReady != 0;
+    }
+    return true;
+}
@@ -0,0 +1,22 @@
+#pragma once
+
+#include <string>
+
+#include "MatchingProblem.h"
+
+// Binary dump of a matching problem, for reproducing a round offline.
+//
+// A snapshot holds the range radius, the RSU capacity, the contact model and,
+// for every vehicle with a ready task or shared resources, its index and
+// state. Other vehicles cannot take part in a matching and are restored with
+// default state. Values are stored in host byte order.
+namespace MatchingSnapshot {
+
+// Returns false if the file could not be written.
+bool write(const std::string &path, const MatchingProblem &problem);
+
+// Returns false if the file could not be read or is no snapshot; problem is
+// left unspecified then. The fog node index of problem is reset.
+bool read(const std::string &path, MatchingProblem &problem);
+
+} // namespace MatchingSnapshot
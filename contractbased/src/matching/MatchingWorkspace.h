@@ -0,0 +1,77 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+// Bump allocator for the scratch buffers of one matching call.
+//
+// reset() releases all buffers at once but keeps the memory. When a call
+// needed more than the current block, further blocks of at least double the
+// size are chained in, and the next reset() merges them into a single block,
+// so after the first few calls a matcher runs without touching the heap.
+class MatchingWorkspace {
+private:
+    struct Block {
+        std::unique_ptr<char[]> data;
+        size_t size;
+    };
+
+    static constexpr size_t alignment = alignof(std::max_align_t);
+
+    std::vector<Block> blocks;
+    size_t used = 0; // bytes used in blocks.back()
+    size_t total = 0; // bytes requested since the last reset()
+
+    void grow(size_t bytes) {
+        size_t size = std::max(bytes, blocks.empty() ? size_t(4096) : 2 * blocks.back().size);
+        blocks.push_back(Block{std::unique_ptr<char[]>(new char[size]), size});
+        used = 0;
+    }
+
+public:
+    // Returns an uninitialized array of count elements, valid until the next reset().
+    template <typename T>
+    T *allocate(size_t count) {
+        static_assert(std::is_trivially_destructible<T>::value, "workspace buffers are never destroyed");
+        static_assert(alignof(T) <= alignment, "type needs stronger alignment than the workspace provides");
+
+        size_t bytes = (count * sizeof(T) + alignment - 1) / alignment * alignment;
+        total += bytes;
+        if (blocks.empty() || used + bytes > blocks.back().size) {
+            grow(bytes);
+        }
+        T *buffer = reinterpret_cast<T *>(blocks.back().data.get() + used);
+        used += bytes;
+        return buffer;
+    }
+
+    // Returns an array of count elements, all set to value.
+    template <typename T>
+    T *allocate(size_t count, const T &value) {
+        T *buffer = allocate<T>(count);
+        std::fill(buffer, buffer + count, value);
+        return buffer;
+    }
+
+    void reset() {
+        if (blocks.size() > 1) {
+            size_t size = blocks.back().size;
+            blocks.clear();
+            grow(std::max(size, total));
+        }
+        used = 0;
+        total = 0;
+    }
+
+    // Bytes currently held
+    size_t capacity() const {
+        size_t size = 0;
+        for (const Block &block : blocks) {
+            size += block.size;
+        }
+        return size;
+    }
+};
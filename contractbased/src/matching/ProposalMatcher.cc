@@ -0,0 +1,89 @@
+#include "ProposalMatcher.h"
+
+#include <algorithm>
+#include <cstdlib>
+
+ProposalMatcher::ProposalMatcher(int maxIterations, double priceIncrease)
+    : maxIterations(maxIterations)
+    , priceIncrease(priceIncrease) {
+}
+
+MatchResult ProposalMatcher::solve(MatchingProblem &problem, const FeasibilityMatrix &feasibility) {
+    std::vector<MatchingVehicle> &vehicles = problem.vehicles;
+    int numVehicles = problem.size();
+
+    MatchResult result;
+    std::vector<int> &proposals = result.assignment;
+    proposals.assign(numVehicles, -1);
+
+    int remainingTasks = feasibility.rows();
+
+    // Proposers of each node in this round as linked lists in proposal order
+    int *proposalCount = workspace.allocate<int>(numVehicles, 0);
+    int *firstProposer = workspace.allocate<int>(numVehicles);
+    int *lastProposer = workspace.allocate<int>(numVehicles);
+    int *nextProposer = workspace.allocate<int>(numVehicles);
+    int *proposedNodes = workspace.allocate<int>(numVehicles);
+
+    int iterations = 0;
+    while (remainingTasks > 0) {
+        int proposedNodeCount = 0;
+        for (int r = 0; r < feasibility.rows(); r++) {
+            int i = feasibility.requester(r);
+            if (proposals[i] != -1) {
+                continue;
+            }
+            double maxPreference = 0;
+            int maxPreferenceId = i;
+            for (size_t k = feasibility.rowBegin(r); k < feasibility.rowEnd(r); k++) {
+                double totalTime = feasibility.totalTime(k);
+                int j = feasibility.node(k);
+                double preference = 1 / totalTime - vehicles[j].taskPrice;
+                if (preference > maxPreference || maxPreferenceId == i) {
+                    maxPreference = preference;
+                    maxPreferenceId = j;
+                }
+            }
+            proposals[i] = maxPreferenceId;
+            nextProposer[i] = -1;
+            if (proposalCount[maxPreferenceId]++ == 0) {
+                firstProposer[maxPreferenceId] = i;
+                proposedNodes[proposedNodeCount++] = maxPreferenceId;
+            } else {
+                nextProposer[lastProposer[maxPreferenceId]] = i;
+            }
+            lastProposer[maxPreferenceId] = i;
+            remainingTasks--;
+        }
+
+        // Resolve conflicts in node order so the tie breaking draws stay in sequence
+        std::sort(proposedNodes, proposedNodes + proposedNodeCount);
+        for (int n = 0; n < proposedNodeCount; n++) {
+            int i = proposedNodes[n];
+            if (proposalCount[i] > 1) {
+                int skipIndex = -1;
+                if (iterations >= 1000 && iterations % 1000 == 0) {
+                    skipIndex = rand() % proposalCount[i];
+                }
+                int j = 0;
+                for (int id = firstProposer[i]; id != -1; id = nextProposer[id], j++) {
+                    if (j == skipIndex)
+                        continue;
+                    proposals[id] = -1;
+                    remainingTasks++;
+                }
+                vehicles[i].taskPrice += priceIncrease;
+            }
+            proposalCount[i] = 0;
+        }
+        if (iterations > maxIterations) {
+            result.iterations = iterations;
+            return result;
+        }
+        iterations++;
+    }
+
+    result.success = true;
+    result.iterations = iterations;
+    return result;
+}
@@ -0,0 +1,22 @@
+#pragma once
+
+#include "Matcher.h"
+
+// Original deferred-acceptance style matcher: every unmatched requester
+// proposes to its preferred fog node, all but (occasionally) one of several
+// proposers to the same node are rejected, and the node's price is raised
+// by a fixed step.
+//
+// Does not clone(), so solves are never split into components: the
+// occasional acceptance draws from rand() must stay in one sequence.
+class ProposalMatcher : public Matcher {
+private:
+    int maxIterations;
+    double priceIncrease;
+
+public:
+    explicit ProposalMatcher(int maxIterations = 10000, double priceIncrease = 0.001);
+
+protected:
+    MatchResult solve(MatchingProblem &problem, const FeasibilityMatrix &feasibility) override;
+};
@@ -0,0 +1,82 @@
+#include "SpatialGrid.h"
+
+#include <cmath>
+
+SpatialGrid::SpatialGrid(double cellSize)
+    : cellSize(cellSize) {
+}
+
+uint64_t SpatialGrid::cellKey(int64_t cellX, int64_t cellY) {
+    return (static_cast<uint64_t>(cellX) << 32) ^ (static_cast<uint64_t>(cellY) & 0xffffffff);
+}
+
+uint64_t SpatialGrid::key(double x, double y) const {
+    return cellKey(static_cast<int64_t>(std::floor(x / cellSize)), static_cast<int64_t>(std::floor(y / cellSize)));
+}
+
+void SpatialGrid::setCellSize(double size) {
+    if (size == cellSize) {
+        return;
+    }
+    cellSize = size;
+    clear();
+}
+
+void SpatialGrid::update(int id, double x, double y) {
+    if (id >= static_cast<int>(slotOf.size())) {
+        cellOf.resize(id + 1, 0);
+        slotOf.resize(id + 1, -1);
+    }
+
+    uint64_t cell = key(x, y);
+    if (slotOf[id] != -1) {
+        if (cellOf[id] == cell) {
+            return;
+        }
+        remove(id);
+    }
+
+    std::vector<int> &members = cells[cell];
+    cellOf[id] = cell;
+    slotOf[id] = static_cast<int>(members.size());
+    members.push_back(id);
+}
+
+void SpatialGrid::remove(int id) {
+    if (!contains(id)) {
+        return;
+    }
+
+    auto it = cells.find(cellOf[id]);
+    std::vector<int> &members = it->second;
+    int slot = slotOf[id];
+    members[slot] = members.back();
+    slotOf[members[slot]] = slot;
+    members.pop_back();
+    if (members.empty()) {
+        cells.erase(it);
+    }
+    slotOf[id] = -1;
+}
+
+void SpatialGrid::clear() {
+    cells.clear();
+    cellOf.clear();
+    slotOf.clear();
+}
+
+void SpatialGrid::query(double x, double y, double radius, std::vector<int> &ids) const {
+    int64_t minX = static_cast<int64_t>(std::floor((x - radius) / cellSize));
+    int64_t maxX = static_cast<int64_t>(std::floor((x + radius) / cellSize));
+    int64_t minY = static_cast<int64_t>(std::floor((y - radius) / cellSize));
+    int64_t maxY = static_cast<int64_t>(std::floor((y + radius) / cellSize));
+
+    for (int64_t cellX = minX; cellX <= maxX; cellX++) {
+        for (int64_t cellY = minY; cellY <= maxY; cellY++) {
+            auto it = cells.find(cellKey(cellX, cellY));
+            if (it != cells.end()) {
+                ids.insert(ids.end(), it->second.begin(), it->second.end());
+            }
+        }
+    }
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+// Uniform grid over the x/y plane mapping dense integer ids to positions.
+//
+// Updates and removals are O(1); a query visits only the cells overlapping
+// the square around the query point, so its cost follows the local density
+// instead of the number of entries.
+class SpatialGrid {
+private:
+    double cellSize;
+    std::unordered_map<uint64_t, std::vector<int>> cells;
+
+    // Per id: cell key and slot in that cell's vector, slot -1 if absent
+    std::vector<uint64_t> cellOf;
+    std::vector<int> slotOf;
+
+    uint64_t key(double x, double y) const;
+    static uint64_t cellKey(int64_t cellX, int64_t cellY);
+
+public:
+    explicit SpatialGrid(double cellSize = 400);
+
+    void setCellSize(double cellSize);
+
+    void update(int id, double x, double y);
+    void remove(int id);
+    void clear();
+
+    bool contains(int id) const {
+        return id >= 0 && id < static_cast<int>(slotOf.size()) && slotOf[id] != -1;
+    }
+
+    // Appends the ids in all cells overlapping the square of half width radius
+    // around (x, y). Callers filter by exact distance.
+    void query(double x, double y, double radius, std::vector<int> &ids) const;
+};
@@ -0,0 +1,69 @@
+#include "ThreadPool.h"
+
+#include <algorithm>
+
+ThreadPool::ThreadPool(int size) {
+    if (size <= 0) {
+        size = std::max(1u, std::thread::hardware_concurrency());
+    }
+    for (int worker = 1; worker < size; worker++) {
+        threads.emplace_back(&ThreadPool::work, this, worker);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (std::thread &thread : threads) {
+        thread.join();
+    }
+}
+
+void ThreadPool::drain(std::unique_lock<std::mutex> &lock, int worker) {
+    running++;
+    while (next < count) {
+        int index = next++;
+        lock.unlock();
+        (*task)(worker, index);
+        lock.lock();
+    }
+    if (--running == 0) {
+        done.notify_all();
+    }
+}
+
+void ThreadPool::work(int worker) {
+    std::unique_lock<std::mutex> lock(mutex);
+    unsigned seen = 0;
+    while (true) {
+        wake.wait(lock, [&] { return stopping || loop != seen; });
+        if (stopping) {
+            return;
+        }
+        seen = loop;
+        drain(lock, worker);
+    }
+}
+
+void ThreadPool::parallelFor(int loopCount, const std::function<void(int, int)> &loopTask) {
+    if (threads.empty() || loopCount <= 1) {
+        for (int index = 0; index < loopCount; index++) {
+            loopTask(0, index);
+        }
+        return;
+    }
+
+    std::unique_lock<std::mutex> lock(mutex);
+    task = &loopTask;
+    count = loopCount;
+    next = 0;
+    loop++;
+    wake.notify_all();
+
+    drain(lock, 0);
+    done.wait(lock, [&] { return running == 0 && next >= count; });
+    task = nullptr;
+}
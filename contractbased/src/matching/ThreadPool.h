@@ -0,0 +1,48 @@
+#pragma once
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of worker threads running parallel loops.
+//
+// The threads are started once and sleep between loops, so a loop costs a
+// wake-up instead of a thread start. The calling thread takes part in every
+// loop as worker 0.
+class ThreadPool {
+private:
+    std::vector<std::thread> threads;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable done;
+
+    // Current loop, guarded by mutex
+    const std::function<void(int, int)> *task = nullptr;
+    int count = 0;
+    int next = 0;
+    int running = 0;
+    unsigned loop = 0;
+    bool stopping = false;
+
+    void work(int worker);
+    void drain(std::unique_lock<std::mutex> &lock, int worker);
+
+public:
+    // Starts size - 1 threads; size 0 uses one worker per hardware thread.
+    explicit ThreadPool(int size);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    int size() const {
+        return static_cast<int>(threads.size()) + 1;
+    }
+
+    // Calls task(worker, index) for every index in [0, count) and returns when
+    // all calls have finished. Indices are handed out in increasing order;
+    // calls on the same worker never overlap.
+    void parallelFor(int count, const std::function<void(int, int)> &task);
+};